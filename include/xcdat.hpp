@@ -5,13 +5,23 @@
 
 #include "xcdat/bc_vector_15.hpp"
 #include "xcdat/bc_vector_16.hpp"
+#include "xcdat/bc_vector_32.hpp"
+#include "xcdat/bc_vector_64.hpp"
 #include "xcdat/bc_vector_7.hpp"
+#include "xcdat/bc_vector_7i.hpp"
 #include "xcdat/bc_vector_8.hpp"
+#include "xcdat/delta_trie.hpp"
+#include "xcdat/dictionary_handle.hpp"
+#include "xcdat/key_file.hpp"
+#include "xcdat/key_sorter.hpp"
 #include "xcdat/load_visitor.hpp"
 #include "xcdat/mmap_visitor.hpp"
 #include "xcdat/save_visitor.hpp"
+#include "xcdat/sharded_trie.hpp"
 #include "xcdat/size_visitor.hpp"
 #include "xcdat/trie.hpp"
+#include "xcdat/trie_map.hpp"
+#include "xcdat/trie_merger.hpp"
 
 namespace xcdat {
 
@@ -27,6 +37,15 @@ using trie_7_type = trie<bc_vector_7>;
 //! The trie type with pointer-based DACs using 15-bit integers (for the 1st layer)
 using trie_15_type = trie<bc_vector_15>;
 
+//! The trie type with pointer-based DACs using 7-bit integers, interleaved into cache lines (for the 1st layer)
+using trie_7i_type = trie<bc_vector_7i>;
+
+//! The trie type with plain 32-bit integers without compression
+using trie_32_type = trie<bc_vector_32>;
+
+//! The trie type with plain 64-bit integers without compression
+using trie_64_type = trie<bc_vector_64>;
+
 //! Set the continuous memory block to a new trie instance (for a memory-mapped file).
 template <class Trie>
 [[maybe_unused]] Trie mmap(const char* address) {
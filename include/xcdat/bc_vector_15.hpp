@@ -4,6 +4,7 @@
 
 #include "bit_vector.hpp"
 #include "compact_vector.hpp"
+#include "thread_tools.hpp"
 
 namespace xcdat {
 
@@ -11,6 +12,7 @@ class bc_vector_15 {
   public:
     static constexpr std::uint32_t l1_bits = 15;
     static constexpr std::uint32_t max_levels = 3;
+    static constexpr std::uint32_t type_id = l1_bits;
 
     static constexpr std::uint64_t block_size_l1 = 1ULL << 15;
     static constexpr std::uint64_t block_size_l2 = 1ULL << 31;
@@ -34,64 +36,127 @@ class bc_vector_15 {
     bc_vector_15(bc_vector_15&&) noexcept = default;
     bc_vector_15& operator=(bc_vector_15&&) noexcept = default;
 
+    // The units are encoded on num_threads threads in three passes over the ranges of units:
+    // (1) count the integers at each level, (2) fill the rank tables at the offsets given by
+    // the prefix sums of the counts, and (3) fill the integers at each level.
+    // The result is identical to the serial encoding.
     template <class BcUnits>
-    explicit bc_vector_15(const BcUnits& bc_units, bit_vector::builder&& leaves) {
+    explicit bc_vector_15(const BcUnits& bc_units, bit_vector::builder&& leaves, std::uint32_t num_threads = 1) {
+        enum class pass_type { count, rank, fill };
+
+        struct cursor_type {
+            std::array<std::uint64_t, max_levels> sizes = {};  // # of integers at each level
+            std::uint64_t num_links = 0;
+            std::uint64_t num_frees = 0;
+        };
+
+        const std::uint32_t num_ranges = std::max(num_threads, 1U);
+        std::vector<cursor_type> cursors(num_ranges + 1);
+
         std::vector<std::uint16_t> ints_l1;
         std::vector<std::uint32_t> ints_l2;
         std::vector<std::uint64_t> ints_l3;
         std::array<std::vector<std::uint64_t>, max_levels - 1> ranks;
         std::vector<std::uint64_t> links;
 
-        ints_l1.reserve(bc_units.size() * 2);
-        ranks[0].reserve((bc_units.size() * 2) >> l1_bits);
-        links.reserve(bc_units.size());
-
-        auto append_unit = [&](std::uint64_t x) {
-            if ((ints_l1.size() % block_size_l1) == 0) {
-                ranks[0].push_back(static_cast<std::uint64_t>(ints_l2.size()));
+        auto append_unit = [&](cursor_type& cur, std::uint64_t x, pass_type pass) {
+            auto& pos = cur.sizes;
+            if (pass == pass_type::rank && (pos[0] % block_size_l1) == 0) {
+                ranks[0][pos[0] / block_size_l1] = pos[1];
             }
             if ((x / block_size_l1) == 0) {
-                ints_l1.push_back(static_cast<std::uint16_t>(0 | (x << 1)));
+                if (pass == pass_type::fill) {
+                    ints_l1[pos[0]] = static_cast<std::uint16_t>(0 | (x << 1));
+                }
+                pos[0] += 1;
                 return;
-            } else {
-                const auto i = ints_l2.size() - ranks[0].back();
-                ints_l1.push_back(static_cast<std::uint16_t>(1 | (i << 1)));
+            } else if (pass == pass_type::fill) {
+                const auto i = pos[1] - ranks[0][pos[0] / block_size_l1];
+                ints_l1[pos[0]] = static_cast<std::uint16_t>(1 | (i << 1));
             }
+            pos[0] += 1;
 
-            if ((ints_l2.size() % block_size_l2) == 0) {
-                ranks[1].push_back(static_cast<std::uint64_t>(ints_l3.size()));
+            if (pass == pass_type::rank && (pos[1] % block_size_l2) == 0) {
+                ranks[1][pos[1] / block_size_l2] = pos[2];
             }
             if ((x / block_size_l2) == 0) {
-                ints_l2.push_back(static_cast<std::uint32_t>(0 | (x << 1)));
+                if (pass == pass_type::fill) {
+                    ints_l2[pos[1]] = static_cast<std::uint32_t>(0 | (x << 1));
+                }
+                pos[1] += 1;
                 return;
-            } else {
-                const auto i = ints_l3.size() - ranks[1].back();
-                ints_l2.push_back(static_cast<std::uint32_t>(1 | (i << 1)));
+            } else if (pass == pass_type::fill) {
+                const auto i = pos[2] - ranks[1][pos[1] / block_size_l2];
+                ints_l2[pos[1]] = static_cast<std::uint32_t>(1 | (i << 1));
             }
+            pos[1] += 1;
 
-            ints_l3.push_back(x);
+            if (pass == pass_type::fill) {
+                ints_l3[pos[2]] = x;
+            }
+            pos[2] += 1;
         };
 
-        auto append_leaf = [&](std::uint64_t x) {
-            if ((ints_l1.size() % block_size_l1) == 0) {
-                ranks[0].push_back(static_cast<std::uint64_t>(ints_l2.size()));
+        auto append_leaf = [&](cursor_type& cur, std::uint64_t x, pass_type pass) {
+            auto& pos = cur.sizes;
+            if (pass == pass_type::rank && (pos[0] % block_size_l1) == 0) {
+                ranks[0][pos[0] / block_size_l1] = pos[1];
             }
-            ints_l1.push_back(static_cast<std::uint16_t>(x & 0xFFFFU));
-            links.push_back(x >> 16);
+            if (pass == pass_type::fill) {
+                ints_l1[pos[0]] = static_cast<std::uint16_t>(x & 0xFFFFU);
+                links[cur.num_links] = x >> 16;
+            }
+            pos[0] += 1;
+            cur.num_links += 1;
         };
 
-        for (std::uint64_t i = 0; i < bc_units.size(); ++i) {
-            if (leaves[i]) {
-                append_leaf(bc_units[i].base);
-            } else {
-                append_unit(bc_units[i].base ^ i);
-            }
-            append_unit(bc_units[i].check ^ i);
-            if (bc_units[i].check == i) {
-                m_num_frees += 1;
+        auto run_pass = [&](pass_type pass) {
+            thread_tools::run(num_ranges, [&](std::uint32_t t) {
+                cursor_type cur = pass == pass_type::count ? cursor_type{} : cursors[t];
+                const std::uint64_t beg = bc_units.size() * t / num_ranges;
+                const std::uint64_t end = bc_units.size() * (t + 1) / num_ranges;
+                for (std::uint64_t i = beg; i < end; ++i) {
+                    if (leaves[i]) {
+                        append_leaf(cur, bc_units[i].base, pass);
+                    } else {
+                        append_unit(cur, bc_units[i].base ^ i, pass);
+                    }
+                    append_unit(cur, bc_units[i].check ^ i, pass);
+                    if (bc_units[i].check == i) {
+                        cur.num_frees += 1;
+                    }
+                }
+                if (pass == pass_type::count) {
+                    cursors[t + 1] = cur;
+                }
+            });
+        };
+
+        // (1) Count
+        run_pass(pass_type::count);
+        for (std::uint32_t t = 0; t < num_ranges; ++t) {
+            for (std::uint32_t j = 0; j < max_levels; ++j) {
+                cursors[t + 1].sizes[j] += cursors[t].sizes[j];
             }
+            cursors[t + 1].num_links += cursors[t].num_links;
+            cursors[t + 1].num_frees += cursors[t].num_frees;
         }
 
+        const cursor_type& total = cursors[num_ranges];
+        m_num_frees = total.num_frees;
+        ints_l1.resize(total.sizes[0]);
+        ints_l2.resize(total.sizes[1]);
+        ints_l3.resize(total.sizes[2]);
+        ranks[0].resize((total.sizes[0] + block_size_l1 - 1) / block_size_l1);
+        ranks[1].resize((total.sizes[1] + block_size_l2 - 1) / block_size_l2);
+        links.resize(total.num_links);
+
+        // (2) Rank
+        run_pass(pass_type::rank);
+
+        // (3) Fill
+        run_pass(pass_type::fill);
+
         // release
         m_ints_l1.build(ints_l1);
         m_ints_l2.build(ints_l2);
@@ -119,6 +184,11 @@ class bc_vector_15 {
         return m_leaves[i];
     }
 
+    inline void prefetch(std::uint64_t i) const {
+        __builtin_prefetch(m_ints_l1.data() + i * 2);
+        m_leaves.prefetch(i);
+    }
+
     inline bool is_used(std::uint64_t i) const {
         return check(i) != i;
     }
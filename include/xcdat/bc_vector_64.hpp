@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+
+#include "bit_vector.hpp"
+#include "exception.hpp"
+#include "immutable_vector.hpp"
+#include "thread_tools.hpp"
+
+namespace xcdat {
+
+// Plain BASE/CHECK vectors using 64-bit integers without compression.
+// The leaf flag is stored in the MSB of CHECK, so that a transition reads one unit without branches or ranks.
+class bc_vector_64 {
+  public:
+    static constexpr std::uint32_t l1_bits = sizeof(std::uint64_t) * 8;
+    static constexpr std::uint32_t type_id = l1_bits;
+
+    static constexpr std::uint64_t leaf_flag = 1ULL << (l1_bits - 1);
+
+    struct unit_type {
+        std::uint64_t base;  // or link for a leaf
+        std::uint64_t check;  // with the leaf flag
+    };
+
+  private:
+    std::uint64_t m_num_frees = 0;
+    std::uint64_t m_num_leaves = 0;
+    immutable_vector<unit_type> m_units;
+
+  public:
+    bc_vector_64() = default;
+    virtual ~bc_vector_64() = default;
+
+    bc_vector_64(const bc_vector_64&) = delete;
+    bc_vector_64& operator=(const bc_vector_64&) = delete;
+
+    bc_vector_64(bc_vector_64&&) noexcept = default;
+    bc_vector_64& operator=(bc_vector_64&&) noexcept = default;
+
+    // The units are copied on num_threads threads. An exception is thrown if a CHECK value exceeds 63 bits.
+    template <class BcUnits>
+    explicit bc_vector_64(const BcUnits& bc_units, bit_vector::builder&& leaves, std::uint32_t num_threads = 1) {
+        const std::uint32_t num_ranges = std::max(num_threads, 1U);
+        std::vector<std::array<std::uint64_t, 2>> counts(num_ranges);  // # of frees and leaves in each range
+        std::vector<unit_type> units(bc_units.size());
+
+        thread_tools::run(num_ranges, [&](std::uint32_t t) {
+            const std::uint64_t beg = bc_units.size() * t / num_ranges;
+            const std::uint64_t end = bc_units.size() * (t + 1) / num_ranges;
+            for (std::uint64_t i = beg; i < end; ++i) {
+                const std::uint64_t check = bc_units[i].check;
+                XCDAT_THROW_IF(leaf_flag <= check, "The CHECK values exceed 63 bits.");
+                units[i].base = bc_units[i].base;
+                units[i].check = leaves[i] ? check | leaf_flag : check;
+                counts[t][0] += check == i;
+                counts[t][1] += leaves[i];
+            }
+        });
+
+        for (const auto& count : counts) {
+            m_num_frees += count[0];
+            m_num_leaves += count[1];
+        }
+        m_units.build(units);
+    }
+
+    inline std::uint64_t base(std::uint64_t i) const {
+        return m_units[i].base;
+    }
+
+    inline std::uint64_t check(std::uint64_t i) const {
+        return m_units[i].check & (leaf_flag - 1);
+    }
+
+    inline std::uint64_t link(std::uint64_t i) const {
+        return m_units[i].base;
+    }
+
+    inline bool is_leaf(std::uint64_t i) const {
+        return m_units[i].check >> (l1_bits - 1);
+    }
+
+    inline void prefetch(std::uint64_t i) const {
+        __builtin_prefetch(m_units.data() + i);
+    }
+
+    inline bool is_used(std::uint64_t i) const {
+        return check(i) != i;
+    }
+
+    inline std::uint64_t num_units() const {
+        return m_units.size();
+    }
+
+    inline std::uint64_t num_free_units() const {
+        return m_num_frees;
+    }
+
+    inline std::uint64_t num_nodes() const {
+        return num_units() - num_free_units();
+    }
+
+    inline std::uint64_t num_leaves() const {
+        return m_num_leaves;
+    }
+
+    template <class Visitor>
+    void visit(Visitor& visitor) {
+        visitor.visit(m_num_frees);
+        visitor.visit(m_num_leaves);
+        visitor.visit(m_units);
+    }
+};
+
+}  // namespace xcdat
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <array>
+
+#include "bit_vector.hpp"
+#include "compact_vector.hpp"
+#include "thread_tools.hpp"
+
+namespace xcdat {
+
+// Pointer-based DACs using 7-bit integers for the 1st layer, like bc_vector_7, but the 1st layer is interleaved
+// into 64-byte lines. Each line packs the 1st-layer BASE/CHECK integers and the leaf flags of 26 units together
+// with the rank header to the 2nd layer, so that a transition not overflowing the 1st layer touches one line.
+class bc_vector_7i {
+  public:
+    static constexpr std::uint32_t l1_bits = 7;
+    static constexpr std::uint32_t max_levels = 4;
+    static constexpr std::uint32_t type_id = 71;
+
+    static constexpr std::uint64_t units_per_line = 26;
+    static constexpr std::uint64_t ints_per_line = units_per_line * 2;
+    static constexpr std::uint64_t block_size_l2 = 1ULL << 15;
+    static constexpr std::uint64_t block_size_l3 = 1ULL << 31;
+
+    struct alignas(64) line_type {
+        std::uint64_t rank;  // # of integers in the 2nd layer before the line
+        std::uint32_t leaves;  // leaf flags of the units
+        std::array<std::uint8_t, ints_per_line> ints;  // BASE/CHECK integers in the 1st layer
+    };
+    static_assert(sizeof(line_type) == 64);
+
+  private:
+    std::uint64_t m_num_units = 0;
+    std::uint64_t m_num_frees = 0;
+    immutable_vector<line_type> m_lines;
+    immutable_vector<std::uint16_t> m_ints_l2;
+    immutable_vector<std::uint32_t> m_ints_l3;
+    immutable_vector<std::uint64_t> m_ints_l4;
+    std::array<immutable_vector<std::uint64_t>, max_levels - 2> m_ranks;
+    compact_vector m_links;
+    bit_vector m_leaves;  // for the ranks of links
+
+  public:
+    bc_vector_7i() = default;
+    virtual ~bc_vector_7i() = default;
+
+    bc_vector_7i(const bc_vector_7i&) = delete;
+    bc_vector_7i& operator=(const bc_vector_7i&) = delete;
+
+    bc_vector_7i(bc_vector_7i&&) noexcept = default;
+    bc_vector_7i& operator=(bc_vector_7i&&) noexcept = default;
+
+    // The units are encoded in the same three passes as bc_vector_7, where the ranges of units are aligned
+    // with the lines so that each line is filled by one thread.
+    template <class BcUnits>
+    explicit bc_vector_7i(const BcUnits& bc_units, bit_vector::builder&& leaves, std::uint32_t num_threads = 1) {
+        enum class pass_type { count, rank, fill };
+
+        struct cursor_type {
+            std::array<std::uint64_t, max_levels> sizes = {};  // # of integers at each level
+            std::uint64_t num_links = 0;
+            std::uint64_t num_frees = 0;
+        };
+
+        const std::uint32_t num_ranges = std::max(num_threads, 1U);
+        std::vector<cursor_type> cursors(num_ranges + 1);
+
+        const std::uint64_t num_units = bc_units.size();
+        const std::uint64_t num_lines = (num_units + units_per_line - 1) / units_per_line;
+
+        std::vector<line_type> lines;
+        std::vector<std::uint16_t> ints_l2;
+        std::vector<std::uint32_t> ints_l3;
+        std::vector<std::uint64_t> ints_l4;
+        std::array<std::vector<std::uint64_t>, max_levels - 2> ranks;
+        std::vector<std::uint64_t> links;
+
+        auto append_unit = [&](cursor_type& cur, std::uint64_t x, pass_type pass) {
+            auto& pos = cur.sizes;
+            if (pass == pass_type::rank && (pos[0] % ints_per_line) == 0) {
+                lines[pos[0] / ints_per_line].rank = pos[1];
+            }
+            if ((x >> l1_bits) == 0) {
+                if (pass == pass_type::fill) {
+                    lines[pos[0] / ints_per_line].ints[pos[0] % ints_per_line] = static_cast<std::uint8_t>(0 | (x << 1));
+                }
+                pos[0] += 1;
+                return;
+            } else if (pass == pass_type::fill) {
+                auto& line = lines[pos[0] / ints_per_line];
+                const auto i = pos[1] - line.rank;
+                line.ints[pos[0] % ints_per_line] = static_cast<std::uint8_t>(1 | (i << 1));
+            }
+            pos[0] += 1;
+
+            if (pass == pass_type::rank && (pos[1] % block_size_l2) == 0) {
+                ranks[0][pos[1] / block_size_l2] = pos[2];
+            }
+            if ((x / block_size_l2) == 0) {
+                if (pass == pass_type::fill) {
+                    ints_l2[pos[1]] = static_cast<std::uint16_t>(0 | (x << 1));
+                }
+                pos[1] += 1;
+                return;
+            } else if (pass == pass_type::fill) {
+                const auto i = pos[2] - ranks[0][pos[1] / block_size_l2];
+                ints_l2[pos[1]] = static_cast<std::uint16_t>(1 | (i << 1));
+            }
+            pos[1] += 1;
+
+            if (pass == pass_type::rank && (pos[2] % block_size_l3) == 0) {
+                ranks[1][pos[2] / block_size_l3] = pos[3];
+            }
+            if ((x / block_size_l3) == 0) {
+                if (pass == pass_type::fill) {
+                    ints_l3[pos[2]] = static_cast<std::uint32_t>(0 | (x << 1));
+                }
+                pos[2] += 1;
+                return;
+            } else if (pass == pass_type::fill) {
+                const auto i = pos[3] - ranks[1][pos[2] / block_size_l3];
+                ints_l3[pos[2]] = static_cast<std::uint32_t>(1 | (i << 1));
+            }
+            pos[2] += 1;
+
+            if (pass == pass_type::fill) {
+                ints_l4[pos[3]] = x;
+            }
+            pos[3] += 1;
+        };
+
+        auto append_leaf = [&](cursor_type& cur, std::uint64_t x, pass_type pass) {
+            auto& pos = cur.sizes;
+            if (pass == pass_type::rank && (pos[0] % ints_per_line) == 0) {
+                lines[pos[0] / ints_per_line].rank = pos[1];
+            }
+            if (pass == pass_type::fill) {
+                auto& line = lines[pos[0] / ints_per_line];
+                line.ints[pos[0] % ints_per_line] = static_cast<std::uint8_t>(x & 0xFFU);
+                line.leaves |= 1U << (pos[0] / 2 % units_per_line);
+                links[cur.num_links] = x >> 8;
+            }
+            pos[0] += 1;
+            cur.num_links += 1;
+        };
+
+        auto run_pass = [&](pass_type pass) {
+            thread_tools::run(num_ranges, [&](std::uint32_t t) {
+                cursor_type cur = pass == pass_type::count ? cursor_type{} : cursors[t];
+                const std::uint64_t beg = std::min(num_lines * t / num_ranges * units_per_line, num_units);
+                const std::uint64_t end = std::min(num_lines * (t + 1) / num_ranges * units_per_line, num_units);
+                for (std::uint64_t i = beg; i < end; ++i) {
+                    if (leaves[i]) {
+                        append_leaf(cur, bc_units[i].base, pass);
+                    } else {
+                        append_unit(cur, bc_units[i].base ^ i, pass);
+                    }
+                    append_unit(cur, bc_units[i].check ^ i, pass);
+                    if (bc_units[i].check == i) {
+                        cur.num_frees += 1;
+                    }
+                }
+                if (pass == pass_type::count) {
+                    cursors[t + 1] = cur;
+                }
+            });
+        };
+
+        // (1) Count
+        run_pass(pass_type::count);
+        for (std::uint32_t t = 0; t < num_ranges; ++t) {
+            for (std::uint32_t j = 0; j < max_levels; ++j) {
+                cursors[t + 1].sizes[j] += cursors[t].sizes[j];
+            }
+            cursors[t + 1].num_links += cursors[t].num_links;
+            cursors[t + 1].num_frees += cursors[t].num_frees;
+        }
+
+        const cursor_type& total = cursors[num_ranges];
+        m_num_units = num_units;
+        m_num_frees = total.num_frees;
+        lines.resize(num_lines);
+        ints_l2.resize(total.sizes[1]);
+        ints_l3.resize(total.sizes[2]);
+        ints_l4.resize(total.sizes[3]);
+        ranks[0].resize((total.sizes[1] + block_size_l2 - 1) / block_size_l2);
+        ranks[1].resize((total.sizes[2] + block_size_l3 - 1) / block_size_l3);
+        links.resize(total.num_links);
+
+        // (2) Rank
+        run_pass(pass_type::rank);
+
+        // (3) Fill
+        run_pass(pass_type::fill);
+
+        // release
+        m_lines.build(lines);
+        m_ints_l2.build(ints_l2);
+        m_ints_l3.build(ints_l3);
+        m_ints_l4.build(ints_l4);
+        for (std::uint32_t j = 0; j < m_ranks.size(); ++j) {
+            m_ranks[j].build(ranks[j]);
+        }
+        m_links = compact_vector(links);
+        m_leaves = bit_vector(leaves, true, false);
+    }
+
+    inline std::uint64_t base(std::uint64_t i) const {
+        return access(i * 2) ^ i;
+    }
+
+    inline std::uint64_t check(std::uint64_t i) const {
+        return access(i * 2 + 1) ^ i;
+    }
+
+    inline std::uint64_t link(std::uint64_t i) const {
+        return m_lines[i / units_per_line].ints[i * 2 % ints_per_line] | (m_links[m_leaves.rank(i)] << 8);
+    }
+
+    inline bool is_leaf(std::uint64_t i) const {
+        return (m_lines[i / units_per_line].leaves >> (i % units_per_line)) & 1U;
+    }
+
+    // The interleaved lines, which are aligned to 64 bytes also in a memory-mapped file.
+    inline const line_type* lines() const {
+        return m_lines.data();
+    }
+
+    inline void prefetch(std::uint64_t i) const {
+        __builtin_prefetch(m_lines.data() + i / units_per_line);
+    }
+
+    inline bool is_used(std::uint64_t i) const {
+        return check(i) != i;
+    }
+
+    inline std::uint64_t num_units() const {
+        return m_num_units;
+    }
+
+    inline std::uint64_t num_free_units() const {
+        return m_num_frees;
+    }
+
+    inline std::uint64_t num_nodes() const {
+        return num_units() - num_free_units();
+    }
+
+    inline std::uint64_t num_leaves() const {
+        return m_leaves.num_ones();
+    }
+
+    template <class Visitor>
+    void visit(Visitor& visitor) {
+        visitor.visit(m_num_units);
+        visitor.visit(m_num_frees);
+        visitor.visit(m_lines);
+        visitor.visit(m_ints_l2);
+        visitor.visit(m_ints_l3);
+        visitor.visit(m_ints_l4);
+        for (std::uint32_t j = 0; j < m_ranks.size(); j++) {
+            visitor.visit(m_ranks[j]);
+        }
+        visitor.visit(m_links);
+        visitor.visit(m_leaves);
+    }
+
+  private:
+    inline std::uint64_t access(std::uint64_t i) const {
+        const auto& line = m_lines[i / ints_per_line];
+        const auto b = line.ints[i % ints_per_line];
+        std::uint64_t x = b >> 1;
+        if ((b & 1U) == 0) {
+            return x;
+        }
+        i = line.rank + x;
+
+        x = m_ints_l2[i] >> 1;
+        if ((m_ints_l2[i] & 1U) == 0) {
+            return x;
+        }
+        i = m_ranks[0][i / block_size_l2] + x;
+
+        x = m_ints_l3[i] >> 1;
+        if ((m_ints_l3[i] & 1U) == 0) {
+            return x;
+        }
+        i = m_ranks[1][i / block_size_l3] + x;
+
+        return m_ints_l4[i];
+    }
+};
+
+}  // namespace xcdat
@@ -4,6 +4,7 @@
 
 #include "bit_vector.hpp"
 #include "compact_vector.hpp"
+#include "thread_tools.hpp"
 
 namespace xcdat {
 
@@ -11,6 +12,7 @@ class bc_vector_8 {
   public:
     static constexpr std::uint32_t l1_bits = sizeof(std::uint8_t) * 8;
     static constexpr std::uint32_t max_levels = sizeof(std::uint64_t) / sizeof(std::uint8_t);
+    static constexpr std::uint32_t type_id = l1_bits;
 
   private:
     std::uint32_t m_num_levels = 0;
@@ -30,55 +32,113 @@ class bc_vector_8 {
     bc_vector_8(bc_vector_8&&) noexcept = default;
     bc_vector_8& operator=(bc_vector_8&&) noexcept = default;
 
+    // The units are encoded on num_threads threads in two passes over the ranges of units:
+    // (1) count the integers at each level, and (2) fill the integers at the offsets given by the prefix sums
+    // of the counts. The next flags of each range are concatenated in order.
+    // The result is identical to the serial encoding.
     template <class BcUnits>
-    explicit bc_vector_8(const BcUnits& bc_units, bit_vector::builder&& leaves) {
-        std::array<std::vector<std::uint8_t>, max_levels> bytes;
-        std::array<bit_vector::builder, max_levels> next_flags;  // The last will not be released
-        std::vector<std::uint64_t> links;
+    explicit bc_vector_8(const BcUnits& bc_units, bit_vector::builder&& leaves, std::uint32_t num_threads = 1) {
+        struct cursor_type {
+            std::array<std::uint64_t, max_levels> sizes = {};  // # of integers at each level
+            std::uint64_t num_links = 0;
+            std::uint64_t num_frees = 0;
+            std::uint32_t num_levels = 0;
+        };
 
-        bytes[0].reserve(bc_units.size() * 2);
-        next_flags[0].reserve(bc_units.size() * 2);
-        links.reserve(bc_units.size());
+        const std::uint32_t num_ranges = std::max(num_threads, 1U);
+        std::vector<cursor_type> cursors(num_ranges + 1);
 
-        m_num_levels = 0;
+        std::array<std::vector<std::uint8_t>, max_levels> bytes;
+        std::vector<std::array<bit_vector::builder, max_levels>> next_flags(num_ranges);  // for each range
+        std::vector<std::uint64_t> links;
 
-        auto append_unit = [&](std::uint64_t x) {
+        auto append_unit = [&](cursor_type& cur, std::array<bit_vector::builder, max_levels>& flags, std::uint64_t x,
+                               bool fill) {
             std::uint32_t j = 0;
-            bytes[j].push_back(static_cast<std::uint8_t>(x & 0xFFU));
-            next_flags[j].push_back(true);
+            if (fill) {
+                bytes[j][cur.sizes[j]] = static_cast<std::uint8_t>(x & 0xFFU);
+                flags[j].push_back(true);
+            }
+            cur.sizes[j] += 1;
             x >>= 8;
             while (x) {
                 ++j;
-                bytes[j].push_back(static_cast<std::uint8_t>(x & 0xFFU));
-                next_flags[j].push_back(true);
+                if (fill) {
+                    bytes[j][cur.sizes[j]] = static_cast<std::uint8_t>(x & 0xFFU);
+                    flags[j].push_back(true);
+                }
+                cur.sizes[j] += 1;
                 x >>= 8;
             }
-            next_flags[j].set_bit(next_flags[j].size() - 1, false);
-            m_num_levels = std::max(m_num_levels, j);
+            if (fill) {
+                flags[j].set_bit(flags[j].size() - 1, false);
+            }
+            cur.num_levels = std::max(cur.num_levels, j);
         };
 
-        auto append_leaf = [&](std::uint64_t x) {
-            bytes[0].push_back(static_cast<std::uint8_t>(x & 0xFFU));
-            next_flags[0].push_back(false);
-            links.push_back(x >> 8);
+        auto append_leaf = [&](cursor_type& cur, std::array<bit_vector::builder, max_levels>& flags, std::uint64_t x,
+                               bool fill) {
+            if (fill) {
+                bytes[0][cur.sizes[0]] = static_cast<std::uint8_t>(x & 0xFFU);
+                flags[0].push_back(false);
+                links[cur.num_links] = x >> 8;
+            }
+            cur.sizes[0] += 1;
+            cur.num_links += 1;
         };
 
-        for (std::uint64_t i = 0; i < bc_units.size(); ++i) {
-            if (leaves[i]) {
-                append_leaf(bc_units[i].base);
-            } else {
-                append_unit(bc_units[i].base ^ i);
-            }
-            append_unit(bc_units[i].check ^ i);
-            if (bc_units[i].check == i) {
-                m_num_frees += 1;
+        auto run_pass = [&](bool fill) {
+            thread_tools::run(num_ranges, [&](std::uint32_t t) {
+                cursor_type cur = fill ? cursors[t] : cursor_type{};
+                const std::uint64_t beg = bc_units.size() * t / num_ranges;
+                const std::uint64_t end = bc_units.size() * (t + 1) / num_ranges;
+                for (std::uint64_t i = beg; i < end; ++i) {
+                    if (leaves[i]) {
+                        append_leaf(cur, next_flags[t], bc_units[i].base, fill);
+                    } else {
+                        append_unit(cur, next_flags[t], bc_units[i].base ^ i, fill);
+                    }
+                    append_unit(cur, next_flags[t], bc_units[i].check ^ i, fill);
+                    if (bc_units[i].check == i) {
+                        cur.num_frees += 1;
+                    }
+                }
+                if (!fill) {
+                    cursors[t + 1] = cur;
+                }
+            });
+        };
+
+        // (1) Count
+        run_pass(false);
+        for (std::uint32_t t = 0; t < num_ranges; ++t) {
+            for (std::uint32_t j = 0; j < max_levels; ++j) {
+                next_flags[t][j].reserve(cursors[t + 1].sizes[j]);
+                cursors[t + 1].sizes[j] += cursors[t].sizes[j];
             }
+            cursors[t + 1].num_links += cursors[t].num_links;
+            cursors[t + 1].num_frees += cursors[t].num_frees;
+            cursors[t + 1].num_levels = std::max(cursors[t + 1].num_levels, cursors[t].num_levels);
+        }
+
+        const cursor_type& total = cursors[num_ranges];
+        for (std::uint32_t j = 0; j < max_levels; ++j) {
+            bytes[j].resize(total.sizes[j]);
         }
+        links.resize(total.num_links);
+        m_num_frees = total.num_frees;
+        m_num_levels = total.num_levels;
+
+        // (2) Fill
+        run_pass(true);
 
         // release
         for (std::uint32_t i = 0; i < m_num_levels; ++i) {
+            for (std::uint32_t t = 1; t < num_ranges; ++t) {
+                next_flags[0][i].append(next_flags[t][i]);
+            }
             m_bytes[i].build(bytes[i]);
-            m_nexts[i] = bit_vector(next_flags[i], true, false);
+            m_nexts[i] = bit_vector(next_flags[0][i], true, false);
         }
         m_bytes[m_num_levels].build(bytes[m_num_levels]);
         m_links = compact_vector(links);
@@ -101,6 +161,11 @@ class bc_vector_8 {
         return m_leaves[i];
     }
 
+    inline void prefetch(std::uint64_t i) const {
+        __builtin_prefetch(m_bytes[0].data() + i * 2);
+        m_leaves.prefetch(i);
+    }
+
     inline bool is_used(std::uint64_t i) const {
         return check(i) != i;
     }
@@ -52,6 +52,27 @@ class bit_vector {
             }
         }
 
+        // Get the wi-th 64-bit word, i.e., B[wi*64..wi*64+64)
+        inline std::uint64_t get_word(std::uint64_t wi) const {
+            return m_bits[wi];
+        }
+
+        // Append all the bits of the other builder.
+        void append(const builder& other) {
+            if (m_size % 64 == 0) {
+                m_bits.insert(m_bits.end(), other.m_bits.begin(), other.m_bits.end());
+                m_size += other.m_size;
+                return;
+            }
+            const std::uint64_t shift = m_size % 64;
+            for (std::uint64_t wi = 0; wi < other.m_bits.size(); wi++) {
+                m_bits.back() |= other.m_bits[wi] << shift;
+                m_bits.push_back(other.m_bits[wi] >> (64 - shift));
+            }
+            m_size += other.m_size;
+            m_bits.resize(words_for(m_size));
+        }
+
         inline void resize(std::uint64_t size) {
             m_bits.resize(words_for(size), 0ULL);
             m_size = size;
@@ -113,6 +134,22 @@ class bit_vector {
         return m_bits[i / 64] & (1ULL << (i % 64));
     }
 
+    // Get B[i..i+len) as an integer, where 0 < len <= 64 and i+len <= size()
+    inline std::uint64_t get_bits(std::uint64_t i, std::uint64_t len) const {
+        assert(0 < len && len <= 64 && i + len <= size());
+        const auto [wi, wj] = decompose<64>(i);
+        std::uint64_t x = m_bits[wi] >> wj;
+        if (wj + len > 64) {
+            x |= m_bits[wi + 1] << (64 - wj);
+        }
+        return len == 64 ? x : x & ((1ULL << len) - 1);
+    }
+
+    // Prefetch the word containing B[i]
+    inline void prefetch(std::uint64_t i) const {
+        __builtin_prefetch(m_bits.data() + i / 64);
+    }
+
     // The number of 1s in B[0..i)
     inline std::uint64_t rank(std::uint64_t i) const {
         assert(i <= size());
@@ -64,6 +64,10 @@ class compact_vector {
         return m_bits;
     }
 
+    inline std::uint64_t memory_in_bytes() const {
+        return sizeof(m_size) + sizeof(m_bits) + sizeof(m_mask) + m_chunks.memory_in_bytes();
+    }
+
     template <class Visitor>
     void visit(Visitor& visitor) {
         visitor.visit(m_size);
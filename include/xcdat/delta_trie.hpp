@@ -0,0 +1,341 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "compact_vector.hpp"
+#include "trie.hpp"
+
+namespace xcdat {
+
+//! A dictionary accepting appends on top of a static trie, in the manner of an LSM tree.
+//! New keywords are inserted into a delta of immutable sorted runs and get the IDs following the existing ones.
+//! The runs are merged like a binary counter, so an insert copies O(log n) run pointers and each keyword is
+//! merged O(log n) times, regardless of the delta size.
+//! Once the delta reaches the threshold, it is merged with the static trie into a fresh one on a background
+//! thread, keeping all the IDs. The readers work on an immutable snapshot obtained by one atomic load of
+//! a shared pointer, so they never wait for the merge or the mutex serializing the writers. The atomic load
+//! is not lock-free in common standard libraries, though: it may briefly contend with a writer storing
+//! the next snapshot, for the time of a pointer copy.
+template <class BcVector>
+class delta_trie {
+  public:
+    using trie_type = trie<BcVector>;
+
+  private:
+    // The static part, whose IDs are mapped if it is a merged one.
+    struct base_type {
+        trie_type trie;
+        compact_vector ids;  // trie ID -> ID (empty if the same)
+        compact_vector trie_ids;  // ID -> trie ID (empty if the same)
+
+        inline std::uint64_t to_id(std::uint64_t trie_id) const {
+            return ids.size() != 0 ? ids[trie_id] : trie_id;
+        }
+        inline std::uint64_t to_trie_id(std::uint64_t id) const {
+            return trie_ids.size() != 0 ? trie_ids[id] : id;
+        }
+    };
+
+    // The keywords inserted after the static part. Each string is never moved once inserted,
+    // so the views remain valid while the arena is referenced by a snapshot.
+    using arena_type = std::deque<std::string>;
+
+    // The keywords of consecutive IDs, which is shared by the snapshots and never modified.
+    struct run_type {
+        std::uint64_t beg_id = 0;  // the ID of keys[0]
+        std::vector<std::string_view> keys;  // in order of IDs from beg_id
+        std::vector<std::pair<std::string_view, std::uint64_t>> sorted;  // sorted by keywords
+    };
+
+    struct snapshot_type {
+        std::shared_ptr<const base_type> base;
+        std::shared_ptr<arena_type> arena;
+        std::vector<std::shared_ptr<const run_type>> runs;  // in order of IDs, with decreasing sizes
+        std::uint64_t num_delta_keys = 0;
+
+        inline std::uint64_t num_keys() const {
+            return base->trie.num_keys() + num_delta_keys;
+        }
+
+        // Get the keyword of the ID in the delta.
+        inline std::string_view delta_key(std::uint64_t id) const {
+            auto it = std::upper_bound(runs.begin(), runs.end(), id,
+                                       [](std::uint64_t a, const auto& b) { return a < b->beg_id; });
+            const run_type& run = **(it - 1);
+            return run.keys[id - run.beg_id];
+        }
+    };
+
+    std::shared_ptr<const snapshot_type> m_snapshot;  // accessed only with std::atomic_load/store
+    std::uint64_t m_merge_threshold = 0;
+    std::uint32_t m_num_threads = 1;
+    std::mutex m_mutex;  // for the writers
+    std::thread m_merger;
+    std::atomic<bool> m_is_merging = false;
+
+  public:
+    //! Build the static trie from the input keywords, which are lexicographically sorted and unique.
+    //! The delta is merged once it has merge_threshold keywords. The merged trie is built on num_threads threads.
+    template <class Strings>
+    delta_trie(const Strings& keys, std::uint64_t merge_threshold = 1ULL << 16, std::uint32_t num_threads = 1)
+        : m_merge_threshold(std::max<std::uint64_t>(merge_threshold, 1)), m_num_threads(num_threads) {
+        auto base = std::make_shared<base_type>();
+        base->trie = trie_type(keys, false, num_threads);
+
+        auto snapshot = std::make_shared<snapshot_type>();
+        snapshot->base = std::move(base);
+        snapshot->arena = std::make_shared<arena_type>();
+        std::atomic_store(&m_snapshot, std::shared_ptr<const snapshot_type>(std::move(snapshot)));
+    }
+
+    //! Wait for the running merge.
+    virtual ~delta_trie() {
+        wait_merge();
+    }
+
+    //! Copy constructor (deleted)
+    delta_trie(const delta_trie&) = delete;
+
+    //! Copy constructor (deleted)
+    delta_trie& operator=(const delta_trie&) = delete;
+
+    //! Get the number of stored keywords.
+    inline std::uint64_t num_keys() const {
+        return load_snapshot()->num_keys();
+    }
+
+    //! Get the number of keywords in the static trie.
+    inline std::uint64_t num_static_keys() const {
+        return load_snapshot()->base->trie.num_keys();
+    }
+
+    //! Get the number of keywords in the delta.
+    inline std::uint64_t num_delta_keys() const {
+        return load_snapshot()->num_delta_keys;
+    }
+
+    //! Get the numbers of keywords in the sorted runs of the delta, in order of IDs.
+    inline std::vector<std::uint64_t> delta_run_sizes() const {
+        const auto snapshot = load_snapshot();
+        std::vector<std::uint64_t> sizes;
+        for (const auto& run : snapshot->runs) {
+            sizes.push_back(run->keys.size());
+        }
+        return sizes;
+    }
+
+    //! Check if the delta is being merged.
+    inline bool is_merging() const {
+        return m_is_merging.load();
+    }
+
+    //! Lookup the ID of the keyword in both the static trie and the delta.
+    inline std::optional<std::uint64_t> lookup(std::string_view key) const {
+        return lookup(*load_snapshot(), key);
+    }
+
+    //! Decode the keyword associated with the ID.
+    inline std::string decode(std::uint64_t id) const {
+        const auto snapshot = load_snapshot();
+        const base_type& base = *snapshot->base;
+        if (id < base.trie.num_keys()) {
+            return base.trie.decode(base.to_trie_id(id));
+        }
+        if (id < snapshot->num_keys()) {
+            return std::string(snapshot->delta_key(id));
+        }
+        return std::string();
+    }
+
+    //! Insert the keyword and return its ID. If the keyword is already stored, its ID is returned.
+    //! A new keyword is given the ID num_keys(), and the merge is started if the delta reaches the threshold.
+    std::uint64_t insert(std::string_view key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const auto snapshot = load_snapshot();
+        if (const auto id = lookup(*snapshot, key); id.has_value()) {
+            return id.value();
+        }
+
+        // The new snapshot copies only the pointers to the runs.
+        auto next = std::make_shared<snapshot_type>(*snapshot);
+        const std::string_view stored = next->arena->emplace_back(key);
+        const std::uint64_t id = next->num_keys();
+
+        auto run = std::make_shared<run_type>();
+        run->beg_id = id;
+        run->keys.push_back(stored);
+        run->sorted.emplace_back(stored, id);
+
+        // The last runs not larger than the new one are merged into it, keeping O(log n) runs.
+        while (!next->runs.empty() && next->runs.back()->keys.size() <= run->keys.size()) {
+            run = merge_runs(*next->runs.back(), *run);
+            next->runs.pop_back();
+        }
+        next->runs.push_back(std::move(run));
+        next->num_delta_keys += 1;
+
+        const bool to_merge = m_merge_threshold <= next->num_delta_keys;
+        std::atomic_store(&m_snapshot, std::shared_ptr<const snapshot_type>(std::move(next)));
+
+        if (to_merge && !m_is_merging.load()) {
+            start_merge();
+        }
+        return id;
+    }
+
+    //! Merge the delta into the static trie and wait for it to complete.
+    void merge() {
+        wait_merge();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (load_snapshot()->num_delta_keys == 0) {
+                return;
+            }
+            start_merge();
+        }
+        wait_merge();
+    }
+
+    //! Wait for the running merge, if any.
+    void wait_merge() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_merger.joinable()) {
+            // The merger acquires m_mutex to publish the result, so the lock is released while waiting.
+            std::thread merger = std::move(m_merger);
+            lock.unlock();
+            merger.join();
+        }
+    }
+
+  private:
+    // This takes a lock of the standard library shared with std::atomic_store on the same pointer
+    // (e.g., a spinlock pool in libstdc++), which is held only while the pointer is copied.
+    inline std::shared_ptr<const snapshot_type> load_snapshot() const {
+        return std::atomic_load(&m_snapshot);
+    }
+
+    static std::optional<std::uint64_t> lookup(const snapshot_type& snapshot, std::string_view key) {
+        const base_type& base = *snapshot.base;
+        if (const auto trie_id = base.trie.lookup(key); trie_id.has_value()) {
+            return base.to_id(trie_id.value());
+        }
+        for (const auto& run : snapshot.runs) {
+            auto it = std::lower_bound(run->sorted.begin(), run->sorted.end(), key,
+                                       [](const auto& a, std::string_view b) { return a.first < b; });
+            if (it != run->sorted.end() && it->first == key) {
+                return it->second;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Merge the run and the following one.
+    static std::shared_ptr<run_type> merge_runs(const run_type& a, const run_type& b) {
+        auto run = std::make_shared<run_type>();
+        run->beg_id = a.beg_id;
+        run->keys.reserve(a.keys.size() + b.keys.size());
+        run->keys.insert(run->keys.end(), a.keys.begin(), a.keys.end());
+        run->keys.insert(run->keys.end(), b.keys.begin(), b.keys.end());
+        run->sorted.resize(a.sorted.size() + b.sorted.size());
+        std::merge(a.sorted.begin(), a.sorted.end(), b.sorted.begin(), b.sorted.end(), run->sorted.begin());
+        return run;
+    }
+
+    // Start merging the delta of the current snapshot on the background thread, where m_mutex is held.
+    void start_merge() {
+        if (m_merger.joinable()) {
+            m_merger.join();  // already finished because m_is_merging is false
+        }
+        m_is_merging.store(true);
+        m_merger = std::thread([this, snapshot = load_snapshot()]() {
+            auto merged = merge_base(*snapshot);
+            publish(std::move(merged), snapshot->num_delta_keys);
+            m_is_merging.store(false);
+        });
+    }
+
+    // Build the static trie of the keywords in the snapshot, keeping their IDs.
+    std::shared_ptr<const base_type> merge_base(const snapshot_type& snapshot) const {
+        const base_type& base = *snapshot.base;
+
+        std::vector<std::pair<std::string_view, std::uint64_t>> delta;
+        delta.reserve(snapshot.num_delta_keys);
+        for (const auto& run : snapshot.runs) {
+            delta.insert(delta.end(), run->sorted.begin(), run->sorted.end());
+        }
+        std::sort(delta.begin(), delta.end());
+
+        // Merge the sorted keywords of the static trie and the delta.
+        std::vector<std::string> keys;
+        std::vector<std::uint64_t> ids;
+        keys.reserve(snapshot.num_keys());
+        ids.reserve(snapshot.num_keys());
+
+        auto it = delta.begin();
+        base.trie.enumerate([&](std::uint64_t trie_id, std::string_view key) {
+            for (; it != delta.end() && it->first < key; ++it) {
+                keys.emplace_back(it->first);
+                ids.push_back(it->second);
+            }
+            keys.emplace_back(key);
+            ids.push_back(base.to_id(trie_id));
+        });
+        for (; it != delta.end(); ++it) {
+            keys.emplace_back(it->first);
+            ids.push_back(it->second);
+        }
+
+        auto merged = std::make_shared<base_type>();
+        merged->trie = trie_type(keys, false, m_num_threads);
+
+        std::vector<std::uint64_t> to_ids(keys.size());
+        std::vector<std::uint64_t> to_trie_ids(keys.size());
+        for (std::uint64_t i = 0; i < keys.size(); ++i) {
+            const std::uint64_t trie_id = merged->trie.lookup(keys[i]).value();
+            to_ids[trie_id] = ids[i];
+            to_trie_ids[ids[i]] = trie_id;
+        }
+        merged->ids = compact_vector(to_ids);
+        merged->trie_ids = compact_vector(to_trie_ids);
+        return merged;
+    }
+
+    // Replace the static trie with the merged one, keeping the keywords inserted during the merge in the delta.
+    void publish(std::shared_ptr<const base_type> merged, std::uint64_t num_merged) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const auto snapshot = load_snapshot();
+        auto next = std::make_shared<snapshot_type>();
+        next->base = std::move(merged);
+        next->arena = std::make_shared<arena_type>();
+
+        // The keywords after the first num_merged ones in the delta keep their IDs.
+        auto run = std::make_shared<run_type>();
+        run->beg_id = snapshot->base->trie.num_keys() + num_merged;
+        for (std::uint64_t id = run->beg_id; id < snapshot->num_keys(); ++id) {
+            const std::string_view stored = next->arena->emplace_back(snapshot->delta_key(id));
+            run->keys.push_back(stored);
+            run->sorted.emplace_back(stored, id);
+        }
+        std::sort(run->sorted.begin(), run->sorted.end());
+
+        next->num_delta_keys = run->keys.size();
+        if (!run->keys.empty()) {
+            next->runs.push_back(std::move(run));
+        }
+
+        std::atomic_store(&m_snapshot, std::shared_ptr<const snapshot_type>(std::move(next)));
+    }
+};
+
+}  // namespace xcdat
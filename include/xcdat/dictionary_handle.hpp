@@ -0,0 +1,122 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "exception.hpp"
+#include "mmap_visitor.hpp"
+
+namespace xcdat {
+
+//! A handle to a memory-mapped dictionary file that can be replaced while the dictionary is in use.
+//! Readers get the current dictionary through 'get', which is a single atomic load of a shared pointer,
+//! and keep using it while 'reload' maps a new file and publishes it. The old file is unmapped when
+//! the last reader releases it. 'Trie' is any type written by xcdat::save such as trie or trie_map.
+//!
+//! The dictionary file should be replaced with a rename, not overwritten in place, so that the mapped
+//! old file stays intact until it is unmapped.
+template <class Trie>
+class dictionary_handle {
+  public:
+    using trie_type = Trie;
+
+  private:
+    // A dictionary and its mapped file, which is unmapped on destruction.
+    class mapped_trie {
+      private:
+        // The mapping is a member constructed before m_trie, so it is also unmapped when the constructor throws.
+        struct mapping {
+            void* addr = nullptr;
+            std::uint64_t bytes = 0;
+
+            ~mapping() {
+                if (addr != nullptr) {
+                    ::munmap(addr, bytes);
+                }
+            }
+        };
+
+        mapping m_mapping;
+        trie_type m_trie;
+
+      public:
+        explicit mapped_trie(const std::string& filepath) {
+            const int fd = ::open(filepath.c_str(), O_RDONLY);
+            XCDAT_THROW_IF(fd < 0, "Cannot open the input file.");
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(std::uint32_t))) {
+                ::close(fd);
+                XCDAT_THROW("The input dictionary is broken.");
+            }
+            const std::uint64_t bytes = static_cast<std::uint64_t>(st.st_size);
+
+            // The mapping remains valid after the descriptor is closed.
+            void* addr = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            XCDAT_THROW_IF(addr == MAP_FAILED, "Cannot map the input file.");
+            m_mapping.addr = addr;
+            m_mapping.bytes = bytes;
+
+            mmap_visitor visitor(static_cast<const char*>(addr));
+
+            std::uint32_t type_id;
+            visitor.visit(type_id);
+            XCDAT_THROW_IF(type_id != trie_type::type_id, "The input dictionary type is different.");
+            visitor.visit(m_trie);
+        }
+
+        mapped_trie(const mapped_trie&) = delete;
+        mapped_trie& operator=(const mapped_trie&) = delete;
+
+        inline const trie_type& get() const {
+            return m_trie;
+        }
+    };
+
+    std::shared_ptr<const trie_type> m_trie;  // accessed only with std::atomic_load/store
+    std::atomic<std::uint64_t> m_version = 0;
+
+  public:
+    //! Map the dictionary file.
+    explicit dictionary_handle(const std::string& filepath) {
+        reload(filepath);
+    }
+
+    //! Default destructor
+    virtual ~dictionary_handle() = default;
+
+    //! Copy constructor (deleted)
+    dictionary_handle(const dictionary_handle&) = delete;
+
+    //! Copy constructor (deleted)
+    dictionary_handle& operator=(const dictionary_handle&) = delete;
+
+    //! Get the current dictionary, which stays mapped while the returned pointer is held.
+    inline std::shared_ptr<const trie_type> get() const {
+        return std::atomic_load(&m_trie);
+    }
+
+    //! Get the number of the dictionaries published so far.
+    inline std::uint64_t version() const {
+        return m_version.load();
+    }
+
+    //! Map the dictionary file and publish it in place of the current one.
+    //! If the file cannot be mapped, an exception is thrown and the current dictionary is kept.
+    void reload(const std::string& filepath) {
+        auto mapped = std::make_shared<const mapped_trie>(filepath);
+        // The aliasing constructor shares the ownership of the mapping with the pointer to the dictionary.
+        std::atomic_store(&m_trie, std::shared_ptr<const trie_type>(mapped, &mapped->get()));
+        m_version.fetch_add(1);
+    }
+};
+
+}  // namespace xcdat
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iterator>
 #include <memory>
@@ -48,16 +49,36 @@ class immutable_vector {
         }
     }
 
-    std::uint64_t mmap(const char* address) {
+    // The elements of an over-aligned type, such as cache lines, are serialized after padding so that they start
+    // at a multiple of their alignment from the beginning of the file. 'pos' is the position of the vector.
+    static constexpr std::uint64_t padding_bytes(std::uint64_t pos) {
+        if constexpr (alignof(T) <= sizeof(std::uint64_t)) {
+            return 0;
+        } else {
+            return (alignof(T) - (pos + sizeof(std::uint64_t)) % alignof(T)) % alignof(T);
+        }
+    }
+
+    // The elements are copied if the mapped address is misaligned, i.e., the file is not mapped on a boundary.
+    std::uint64_t mmap(const char* address, std::uint64_t pos = 0) {
         clear();
         m_size = *reinterpret_cast<const std::uint64_t*>(address);
-        m_data = reinterpret_cast<const T*>(address + sizeof(std::uint64_t));
-        return sizeof(std::uint64_t) + m_size * sizeof(T);
+        const char* data = address + sizeof(std::uint64_t) + padding_bytes(pos);
+        if (m_size != 0 && reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0) {
+            m_allocator = std::make_unique<T[]>(m_size);
+            std::memcpy(static_cast<void*>(m_allocator.get()), data, sizeof(T) * m_size);
+            m_data = m_allocator.get();
+        } else {
+            m_data = reinterpret_cast<const T*>(data);
+        }
+        return sizeof(std::uint64_t) + padding_bytes(pos) + m_size * sizeof(T);
     }
 
     void load(std::ifstream& ifs) {
         clear();
+        const std::uint64_t pos = ifs.tellg();
         ifs.read(reinterpret_cast<char*>(&m_size), sizeof(m_size));
+        ifs.ignore(padding_bytes(pos));
         if (m_size != 0) {
             m_allocator = std::make_unique<T[]>(m_size);
             ifs.read(reinterpret_cast<char*>(m_allocator.get()), sizeof(T) * m_size);
@@ -66,12 +87,16 @@ class immutable_vector {
     }
 
     void save(std::ofstream& ofs) const {
+        const std::uint64_t pos = ofs.tellp();
         ofs.write(reinterpret_cast<const char*>(&m_size), sizeof(m_size));
+        for (std::uint64_t i = 0; i < padding_bytes(pos); i++) {
+            ofs.put('\0');
+        }
         ofs.write(reinterpret_cast<const char*>(m_data), sizeof(T) * m_size);
     }
 
-    inline std::uint64_t memory_in_bytes() const {
-        return sizeof(m_size) + sizeof(T) * m_size;
+    inline std::uint64_t memory_in_bytes(std::uint64_t pos = 0) const {
+        return sizeof(m_size) + padding_bytes(pos) + sizeof(T) * m_size;
     }
 
     inline std::uint64_t size() const {
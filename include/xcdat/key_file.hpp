@@ -0,0 +1,232 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "exception.hpp"
+#include "spill_vector.hpp"
+
+namespace xcdat {
+
+//! A read-only random-access container of the keys stored in a file, which can be passed to the trie
+//! constructor in place of std::vector<std::string>. The file is memory-mapped, so the keys are paged in
+//! from the disk on demand and are not copied. The key positions are indexed in a spill_vector and spilled
+//! to a temporary file beyond the memory budget.
+//!
+//! The following file formats are supported:
+//!  - newline: each key is terminated by '\n' (the last one can omit it).
+//!  - length_prefixed: each key is preceded by its length in 4-byte little endian,
+//!    so the keys can contain any bytes including '\n' and '\0'.
+class key_file {
+  public:
+    enum class format { newline, length_prefixed };
+
+    using value_type = std::string_view;
+
+    //! The random-access iterator over the keys
+    class iterator {
+      public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::int64_t;
+        using pointer = void;
+        using reference = std::string_view;
+
+      private:
+        const key_file* m_obj = nullptr;
+        std::uint64_t m_i = 0;
+
+      public:
+        iterator() = default;
+        iterator(const key_file* obj, std::uint64_t i) : m_obj(obj), m_i(i) {}
+
+        inline std::string_view operator*() const {
+            return (*m_obj)[m_i];
+        }
+        inline std::string_view operator[](difference_type n) const {
+            return (*m_obj)[m_i + n];
+        }
+
+        inline iterator& operator++() {
+            m_i += 1;
+            return *this;
+        }
+        inline iterator operator++(int) {
+            iterator it = *this;
+            m_i += 1;
+            return it;
+        }
+        inline iterator& operator--() {
+            m_i -= 1;
+            return *this;
+        }
+        inline iterator operator--(int) {
+            iterator it = *this;
+            m_i -= 1;
+            return it;
+        }
+        inline iterator& operator+=(difference_type n) {
+            m_i += n;
+            return *this;
+        }
+        inline iterator& operator-=(difference_type n) {
+            m_i -= n;
+            return *this;
+        }
+        inline iterator operator+(difference_type n) const {
+            return iterator(m_obj, m_i + n);
+        }
+        inline iterator operator-(difference_type n) const {
+            return iterator(m_obj, m_i - n);
+        }
+        inline difference_type operator-(const iterator& other) const {
+            return static_cast<difference_type>(m_i) - static_cast<difference_type>(other.m_i);
+        }
+
+        inline bool operator==(const iterator& other) const {
+            return m_i == other.m_i;
+        }
+        inline bool operator!=(const iterator& other) const {
+            return m_i != other.m_i;
+        }
+        inline bool operator<(const iterator& other) const {
+            return m_i < other.m_i;
+        }
+    };
+
+  private:
+    static constexpr std::uint64_t prefix_bytes = 4;
+
+    format m_format = format::newline;
+    const char* m_data = nullptr;
+    std::uint64_t m_bytes = 0;
+    int m_fd = -1;
+    spill_vector<std::uint64_t> m_begs;  // The beginning positions of the keys, with a sentinel
+
+  public:
+    //! Default constructor
+    key_file() = default;
+
+    //! Open the key file and index the keys. The index is spilled to a temporary file if its size exceeds
+    //! memory_budget bytes.
+    explicit key_file(const std::string& filepath, format fmt = format::newline,
+                      std::uint64_t memory_budget = spill_vector<std::uint64_t>::unlimited)
+        : m_format(fmt), m_begs(memory_budget) {
+        m_fd = ::open(filepath.c_str(), O_RDONLY);
+        XCDAT_THROW_IF(m_fd < 0, "Cannot open the input file.");
+
+        // The destructor is not called when the constructor throws, so the resources are released here.
+        struct stat st;
+        if (::fstat(m_fd, &st) != 0) {
+            release();
+            XCDAT_THROW("Cannot get the size of the input file.");
+        }
+        m_bytes = static_cast<std::uint64_t>(st.st_size);
+
+        if (m_bytes != 0) {
+            void* addr = ::mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, m_fd, 0);
+            if (addr == MAP_FAILED) {
+                release();
+                XCDAT_THROW("Cannot map the input file.");
+            }
+            m_data = static_cast<const char*>(addr);
+            // The keys are read almost sequentially in construction.
+            ::madvise(addr, m_bytes, MADV_SEQUENTIAL);
+        }
+
+        try {
+            if (m_format == format::newline) {
+                index_lines();
+            } else {
+                index_length_prefixed();
+            }
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    //! Default destructor
+    virtual ~key_file() {
+        release();
+    }
+
+    //! Copy constructor (deleted)
+    key_file(const key_file&) = delete;
+
+    //! Copy constructor (deleted)
+    key_file& operator=(const key_file&) = delete;
+
+    //! Get the i-th key.
+    inline std::string_view operator[](std::uint64_t i) const {
+        const std::uint64_t beg = m_begs[i];
+        const std::uint64_t end = m_begs[i + 1] - (m_format == format::newline ? 1 : prefix_bytes);
+        return std::string_view(m_data + beg, end - beg);
+    }
+
+    //! Get the number of keys.
+    inline std::uint64_t size() const {
+        return m_begs.size() - 1;
+    }
+
+    //! Check if the index is spilled to a temporary file.
+    inline bool is_spilled() const {
+        return m_begs.is_spilled();
+    }
+
+    inline iterator begin() const {
+        return iterator(this, 0);
+    }
+
+    inline iterator end() const {
+        return iterator(this, size());
+    }
+
+  private:
+    void release() {
+        if (m_data != nullptr) {
+            ::munmap(const_cast<char*>(m_data), m_bytes);
+            m_data = nullptr;
+        }
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    void index_lines() {
+        std::uint64_t pos = 0;
+        while (pos < m_bytes) {
+            m_begs.push_back(pos);
+            const void* found = std::memchr(m_data + pos, '\n', m_bytes - pos);
+            pos = found ? static_cast<const char*>(found) - m_data + 1 : m_bytes + 1;
+        }
+        m_begs.push_back(pos);
+    }
+
+    void index_length_prefixed() {
+        std::uint64_t pos = 0;
+        while (pos < m_bytes) {
+            XCDAT_THROW_IF(m_bytes - pos < prefix_bytes, "The length prefix is broken.");
+            std::uint64_t length = 0;
+            for (std::uint64_t j = 0; j < prefix_bytes; j++) {
+                length |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(m_data[pos + j])) << (j * 8);
+            }
+            pos += prefix_bytes;
+            XCDAT_THROW_IF(m_bytes - pos < length, "The key length exceeds the file size.");
+            m_begs.push_back(pos);
+            pos += length;
+        }
+        m_begs.push_back(pos + prefix_bytes);
+    }
+};
+
+}  // namespace xcdat
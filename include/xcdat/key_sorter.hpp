@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "exception.hpp"
+#include "thread_tools.hpp"
+
+namespace xcdat {
+
+//! An external sorter to prepare the input keys of the trie construction.
+//! The added keys are buffered in memory. When the buffer exceeds the memory budget, its keys are sorted
+//! on num_threads threads and spilled to a temporary file as a sorted run without duplicates.
+//! Finally, the runs are merged into the sorted unique keys.
+class key_sorter {
+  public:
+    static constexpr std::uint64_t unlimited = UINT64_MAX;
+
+  private:
+    // The bytes per buffered key other than its characters, i.e., its position and view
+    static constexpr std::uint64_t overhead_per_key = sizeof(std::uint64_t) + sizeof(std::string_view);
+
+    std::uint64_t m_memory_budget = unlimited;  // in bytes
+    std::uint32_t m_num_threads = 1;
+    std::vector<char> m_chars;
+    std::vector<std::uint64_t> m_begs;  // The beginning positions of the buffered keys in m_chars
+    std::vector<std::FILE*> m_runs;
+
+  public:
+    //! Default constructor
+    key_sorter() = default;
+
+    //! Make the sorter buffering at most memory_budget bytes.
+    explicit key_sorter(std::uint64_t memory_budget, std::uint32_t num_threads = 1)
+        : m_memory_budget(memory_budget), m_num_threads(std::max(num_threads, 1U)) {}
+
+    //! Default destructor
+    virtual ~key_sorter() {
+        for (std::FILE* run : m_runs) {
+            std::fclose(run);
+        }
+    }
+
+    //! Copy constructor (deleted)
+    key_sorter(const key_sorter&) = delete;
+
+    //! Copy constructor (deleted)
+    key_sorter& operator=(const key_sorter&) = delete;
+
+    //! Add a key.
+    void add(std::string_view key) {
+        XCDAT_THROW_IF(key.size() > UINT32_MAX, "The key is too long.");
+        m_begs.push_back(m_chars.size());
+        m_chars.insert(m_chars.end(), key.begin(), key.end());
+        if (buffered_bytes() > m_memory_budget) {
+            spill();
+        }
+    }
+
+    //! Get the number of runs spilled to temporary files.
+    inline std::uint64_t num_runs() const {
+        return m_runs.size();
+    }
+
+    //! Call fn(key) for each unique key in the sorted order, and returns the number of the unique keys.
+    //! The sorter is emptied.
+    template <class Fn>
+    std::uint64_t merge(Fn&& fn) {
+        if (m_runs.empty()) {
+            // All the keys are in memory.
+            std::uint64_t num_keys = 0;
+            for_each_unique(sort_buffer(), [&](std::string_view key) {
+                fn(key);
+                num_keys += 1;
+            });
+            clear_buffer();
+            return num_keys;
+        }
+
+        spill();
+
+        struct cursor_type {
+            std::string key;
+            std::FILE* run;
+        };
+        auto greater = [](const cursor_type* a, const cursor_type* b) { return a->key > b->key; };
+
+        std::vector<cursor_type> cursors(m_runs.size());
+        std::priority_queue<cursor_type*, std::vector<cursor_type*>, decltype(greater)> heap(greater);
+
+        for (std::uint64_t i = 0; i < m_runs.size(); i++) {
+            std::rewind(m_runs[i]);
+            cursors[i].run = m_runs[i];
+            if (read_key(cursors[i].run, cursors[i].key)) {
+                heap.push(&cursors[i]);
+            }
+        }
+
+        std::uint64_t num_keys = 0;
+        std::string last_key;
+
+        while (!heap.empty()) {
+            cursor_type* cur = heap.top();
+            heap.pop();
+            if (num_keys == 0 || cur->key != last_key) {
+                fn(std::string_view(cur->key));
+                last_key = cur->key;
+                num_keys += 1;
+            }
+            if (read_key(cur->run, cur->key)) {
+                heap.push(cur);
+            }
+        }
+
+        for (std::FILE* run : m_runs) {
+            std::fclose(run);
+        }
+        m_runs.clear();
+
+        return num_keys;
+    }
+
+    //! Write the sorted unique keys into the file in the length-prefixed format of xcdat::key_file,
+    //! and returns the number of the keys. The sorter is emptied.
+    std::uint64_t write(const std::string& filepath) {
+        std::FILE* out = std::fopen(filepath.c_str(), "wb");
+        XCDAT_THROW_IF(out == nullptr, "Cannot open the output file.");
+        const std::uint64_t num_keys = merge([&](std::string_view key) { write_key(out, key); });
+        XCDAT_THROW_IF(std::fclose(out) != 0, "Failed to write the output file.");
+        return num_keys;
+    }
+
+  private:
+    inline std::uint64_t buffered_bytes() const {
+        return m_chars.size() + m_begs.size() * overhead_per_key;
+    }
+
+    std::vector<std::string_view> sort_buffer() const {
+        std::vector<std::string_view> keys(m_begs.size());
+        for (std::uint64_t i = 0; i < m_begs.size(); i++) {
+            const std::uint64_t end = i + 1 < m_begs.size() ? m_begs[i + 1] : m_chars.size();
+            keys[i] = std::string_view(m_chars.data() + m_begs[i], end - m_begs[i]);
+        }
+        thread_tools::sort(keys.begin(), keys.end(), std::less<std::string_view>(), m_num_threads);
+        return keys;
+    }
+
+    template <class Fn>
+    static void for_each_unique(const std::vector<std::string_view>& keys, Fn&& fn) {
+        for (std::uint64_t i = 0; i < keys.size(); i++) {
+            if (i == 0 || keys[i - 1] != keys[i]) {
+                fn(keys[i]);
+            }
+        }
+    }
+
+    void clear_buffer() {
+        m_chars = std::vector<char>();
+        m_begs = std::vector<std::uint64_t>();
+    }
+
+    // Write the buffered keys as a sorted run.
+    void spill() {
+        if (m_begs.empty()) {
+            return;
+        }
+        std::FILE* run = std::tmpfile();
+        XCDAT_THROW_IF(run == nullptr, "Failed to make a temporary file.");
+        m_runs.push_back(run);
+
+        for_each_unique(sort_buffer(), [&](std::string_view key) { write_key(run, key); });
+        XCDAT_THROW_IF(std::fflush(run) != 0, "Failed to write a temporary file.");
+
+        m_chars.clear();
+        m_begs.clear();
+    }
+
+    // Write the key preceded by its length in 4-byte little endian.
+    static void write_key(std::FILE* out, std::string_view key) {
+        char prefix[4];
+        for (std::uint64_t j = 0; j < 4; j++) {
+            prefix[j] = static_cast<char>((key.size() >> (j * 8)) & 0xFFU);
+        }
+        XCDAT_THROW_IF(std::fwrite(prefix, 1, 4, out) != 4, "Failed to write a key.");
+        XCDAT_THROW_IF(std::fwrite(key.data(), 1, key.size(), out) != key.size(), "Failed to write a key.");
+    }
+
+    static bool read_key(std::FILE* in, std::string& key) {
+        unsigned char prefix[4];
+        if (std::fread(prefix, 1, 4, in) != 4) {
+            return false;
+        }
+        std::uint64_t length = 0;
+        for (std::uint64_t j = 0; j < 4; j++) {
+            length |= static_cast<std::uint64_t>(prefix[j]) << (j * 8);
+        }
+        key.resize(length);
+        XCDAT_THROW_IF(std::fread(key.data(), 1, length, in) != length, "Failed to read a key.");
+        return true;
+    }
+};
+
+}  // namespace xcdat
@@ -18,7 +18,7 @@ class mmap_visitor {
 
     template <typename T>
     void visit(immutable_vector<T>& vec) {
-        m_cur += vec.mmap(m_cur);
+        m_cur += vec.mmap(m_cur, m_cur - m_base);
     }
 
     template <typename T>
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "trie.hpp"
+
+namespace xcdat {
+
+//! A trie dictionary partitioned into shards of contiguous key ranges, which are built in parallel.
+//! The i-th shard is an independent trie<BcVector> storing the keywords in [bound(i), bound(i+1)),
+//! where bound(i) is the first keyword of the shard kept in the shard directory.
+//! The global ID of a keyword is the offset of its shard plus its ID in the shard.
+template <class BcVector>
+class sharded_trie {
+  public:
+    using trie_type = trie<BcVector>;
+
+    //! The type identifier, distinguished from that of a single trie.
+    static constexpr std::uint32_t type_id = trie_type::type_id | (1U << 24);
+
+  private:
+    // A view of keys[beg..end) given to the constructor of a shard.
+    template <class Strings>
+    class strings_range {
+      public:
+        using value_type = typename Strings::value_type;
+
+      private:
+        const Strings& m_keys;
+        std::uint64_t m_beg;
+        std::uint64_t m_end;
+
+      public:
+        strings_range(const Strings& keys, std::uint64_t beg, std::uint64_t end)
+            : m_keys(keys), m_beg(beg), m_end(end) {}
+
+        inline std::uint64_t size() const {
+            return m_end - m_beg;
+        }
+        inline decltype(auto) operator[](std::uint64_t i) const {
+            return m_keys[m_beg + i];
+        }
+        inline auto begin() const {
+            return m_keys.begin() + m_beg;
+        }
+        inline auto end() const {
+            return m_keys.begin() + m_end;
+        }
+    };
+
+    std::uint64_t m_num_keys = 0;
+    immutable_vector<std::uint64_t> m_offsets;  // The first global ID of each shard (and the sentinel)
+    immutable_vector<std::uint64_t> m_bound_begs;  // The positions of the bounds in m_bound_chars
+    immutable_vector<char> m_bound_chars;  // The concatenated bounds, i.e., the first keywords of the shards
+    std::vector<trie_type> m_shards;
+
+  public:
+    //! Default constructor
+    sharded_trie() = default;
+
+    //! Default destructor
+    virtual ~sharded_trie() = default;
+
+    //! Copy constructor (deleted)
+    sharded_trie(const sharded_trie&) = delete;
+
+    //! Copy constructor (deleted)
+    sharded_trie& operator=(const sharded_trie&) = delete;
+
+    //! Move constructor
+    sharded_trie(sharded_trie&&) noexcept = default;
+
+    //! Move constructor
+    sharded_trie& operator=(sharded_trie&&) noexcept = default;
+
+    //! Build the dictionary from the input keywords, which are lexicographically sorted and unique.
+    //! The keywords are split into num_shards ranges of the same size, and each shard is built on its own thread.
+    //! The memory budget is divided among the shards. See trie for the other arguments.
+    template <class Strings>
+    sharded_trie(const Strings& keys, std::uint32_t num_shards, bool bin_mode = false,
+                 std::uint64_t memory_budget = UINT64_MAX) {
+        XCDAT_THROW_IF(keys.size() == 0, "The input dataset is empty.");
+        num_shards = static_cast<std::uint32_t>(std::clamp<std::uint64_t>(num_shards, 1, keys.size()));
+
+        std::vector<std::uint64_t> begs(num_shards + 1);
+        for (std::uint32_t s = 0; s <= num_shards; s++) {
+            begs[s] = keys.size() * s / num_shards;
+        }
+
+        m_shards.resize(num_shards);
+        thread_tools::run(num_shards, [&](std::uint32_t s) {
+            m_shards[s] = trie_type(strings_range<Strings>(keys, begs[s], begs[s + 1]), bin_mode, 1,
+                                    memory_budget / num_shards);
+        });
+
+        std::vector<std::uint64_t> bound_begs = {0};
+        std::vector<char> bound_chars;
+        for (std::uint32_t s = 0; s < num_shards; s++) {
+            const auto& bound = keys[begs[s]];
+            bound_chars.insert(bound_chars.end(), bound.data(), bound.data() + bound.size());
+            bound_begs.push_back(bound_chars.size());
+        }
+
+        m_num_keys = keys.size();
+        m_offsets.build(begs);
+        m_bound_begs.build(bound_begs);
+        m_bound_chars.build(bound_chars);
+    }
+
+    //! Get the number of stored keywords.
+    inline std::uint64_t num_keys() const {
+        return m_num_keys;
+    }
+
+    //! Get the number of shards.
+    inline std::uint64_t num_shards() const {
+        return m_shards.size();
+    }
+
+    //! Get the i-th shard.
+    inline const trie_type& get_shard(std::uint64_t i) const {
+        return m_shards[i];
+    }
+
+    //! Get the global ID of the first keyword in the i-th shard.
+    inline std::uint64_t shard_offset(std::uint64_t i) const {
+        return m_offsets[i];
+    }
+
+    //! Get the first keyword in the i-th shard.
+    inline std::string_view shard_bound(std::uint64_t i) const {
+        return std::string_view(m_bound_chars.data() + m_bound_begs[i], m_bound_begs[i + 1] - m_bound_begs[i]);
+    }
+
+    //! Build the label links of the shards in parallel (see trie::build_label_links).
+    void build_label_links(std::uint32_t num_threads = 1) {
+        thread_tools::run_ranges(num_threads, num_shards(), [&](std::uint64_t beg, std::uint64_t end) {
+            for (std::uint64_t s = beg; s < end; s++) {
+                m_shards[s].build_label_links();
+            }
+        });
+    }
+
+    //! Lookup the global ID of the keyword.
+    inline std::optional<std::uint64_t> lookup(std::string_view key) const {
+        const std::uint64_t s = route(key);
+        const auto id = m_shards[s].lookup(key);
+        if (!id.has_value()) {
+            return std::nullopt;
+        }
+        return m_offsets[s] + id.value();
+    }
+
+    //! Decode the keyword associated with the global ID.
+    inline std::string decode(std::uint64_t id) const {
+        std::string decoded;
+        decode(id, decoded);
+        return decoded;
+    }
+
+    //! Decode the keyword associated with the global ID and store it in 'decoded'.
+    inline void decode(std::uint64_t id, std::string& decoded) const {
+        if (num_keys() <= id) {
+            decoded.clear();
+            return;
+        }
+        const std::uint64_t s = std::upper_bound(m_offsets.begin(), m_offsets.end(), id) - m_offsets.begin() - 1;
+        m_shards[s].decode(id - m_offsets[s], decoded);
+    }
+
+    //! Preform common prefix search for the keyword.
+    inline void prefix_search(std::string_view key,
+                              const std::function<void(std::uint64_t, std::string_view)>& fn) const {
+        prefix_search<const std::function<void(std::uint64_t, std::string_view)>&>(key, fn);
+    }
+
+    //! Preform common prefix search for the keyword, where 'fn(id, keyword)' is inlined.
+    //! The prefixes stored in each shard are those of the keyword truncated to before its bound,
+    //! so the shards are visited backward from the routed one, and then searched in order of IDs.
+    template <class Fn>
+    inline void prefix_search(std::string_view key, Fn&& fn) const {
+        std::vector<std::pair<std::uint64_t, std::string_view>> queries;
+        for (std::string_view query = key;;) {
+            const std::uint64_t s = route(query);
+            queries.emplace_back(s, query);
+            if (s == 0) {
+                break;
+            }
+            // Only the prefixes shorter than the bound are stored in the previous shards.
+            const std::string_view bound = shard_bound(s);
+            const std::uint64_t lcp = std::mismatch(query.begin(), query.end(), bound.begin(), bound.end()).first -
+                                      query.begin();
+            query = query.substr(0, lcp < bound.size() ? lcp : lcp - 1);
+        }
+
+        for (auto it = queries.rbegin(); it != queries.rend(); ++it) {
+            const std::uint64_t offset = m_offsets[it->first];
+            m_shards[it->first].prefix_search(
+                it->second, [&](std::uint64_t id, std::string_view decoded) { fn(offset + id, decoded); });
+        }
+    }
+
+    //! Preform predictive search for the keyword.
+    inline void predictive_search(std::string_view key,
+                                  const std::function<void(std::uint64_t, std::string_view)>& fn) const {
+        predictive_search<const std::function<void(std::uint64_t, std::string_view)>&>(key, fn);
+    }
+
+    //! Preform predictive search for the keyword, where 'fn(id, keyword)' is inlined.
+    //! The results span the routed shard and the following shards whose bounds start with the keyword.
+    template <class Fn>
+    inline void predictive_search(std::string_view key, Fn&& fn) const {
+        const std::uint64_t beg = route(key);
+        for (std::uint64_t s = beg; s < num_shards(); s++) {
+            if (s != beg && shard_bound(s).substr(0, key.size()) != key) {
+                break;
+            }
+            const std::uint64_t offset = m_offsets[s];
+            m_shards[s].predictive_search(key,
+                                          [&](std::uint64_t id, std::string_view decoded) { fn(offset + id, decoded); });
+        }
+    }
+
+    //! Enumerate all the keywords and their global IDs stored in the shards.
+    inline void enumerate(const std::function<void(std::uint64_t, std::string_view)>& fn) const {
+        enumerate<const std::function<void(std::uint64_t, std::string_view)>&>(fn);
+    }
+
+    //! Enumerate all the keywords and their global IDs stored in the shards, where 'fn(id, keyword)' is inlined.
+    template <class Fn>
+    inline void enumerate(Fn&& fn) const {
+        for (std::uint64_t s = 0; s < num_shards(); s++) {
+            const std::uint64_t offset = m_offsets[s];
+            m_shards[s].enumerate([&](std::uint64_t id, std::string_view decoded) { fn(offset + id, decoded); });
+        }
+    }
+
+    //! Visit the members (commonly used for I/O).
+    template <class Visitor>
+    void visit(Visitor& visitor) {
+        visitor.visit(m_num_keys);
+        visitor.visit(m_offsets);
+        visitor.visit(m_bound_begs);
+        visitor.visit(m_bound_chars);
+        m_shards.resize(m_offsets.size() != 0 ? m_offsets.size() - 1 : 0);  // for loading
+        for (auto& shard : m_shards) {
+            visitor.visit(shard);
+        }
+    }
+
+  private:
+    // The last shard whose bound is not greater than the keyword, or the first shard.
+    inline std::uint64_t route(std::string_view key) const {
+        std::uint64_t lo = 1, hi = num_shards();
+        while (lo < hi) {
+            const std::uint64_t mi = (lo + hi) / 2;
+            if (shard_bound(mi) <= key) {
+                lo = mi + 1;
+            } else {
+                hi = mi;
+            }
+        }
+        return lo - 1;
+    }
+};
+
+}  // namespace xcdat
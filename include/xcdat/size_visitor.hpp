@@ -19,7 +19,7 @@ class size_visitor {
 
     template <typename T>
     void visit(const immutable_vector<T>& vec) {
-        m_bytes += vec.memory_in_bytes();
+        m_bytes += vec.memory_in_bytes(m_bytes);
     }
 
     template <typename T>
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "exception.hpp"
+
+namespace xcdat {
+
+// A growable vector of trivially-copyable elements for construction buffers. The elements are kept on the heap
+// while the capacity fits in the memory budget. Beyond the budget, they are spilled to an unlinked temporary file
+// mapped into memory, so that the OS can write them back to the disk under memory pressure.
+template <class T>
+class spill_vector {
+    static_assert(std::is_trivially_copyable_v<T>, "spill_vector supports only trivially-copyable types.");
+
+  public:
+    static constexpr std::uint64_t unlimited = UINT64_MAX;
+
+  private:
+    std::uint64_t m_budget = unlimited;  // in bytes
+    std::uint64_t m_size = 0;
+    std::uint64_t m_capa = 0;
+    T* m_data = nullptr;
+    int m_fd = -1;  // The temporary file if spilled
+
+  public:
+    spill_vector() = default;
+
+    explicit spill_vector(std::uint64_t budget) : m_budget(budget) {}
+
+    virtual ~spill_vector() {
+        clear();
+    }
+
+    spill_vector(const spill_vector&) = delete;
+    spill_vector& operator=(const spill_vector&) = delete;
+
+    spill_vector(spill_vector&& other) noexcept {
+        swap(other);
+    }
+    spill_vector& operator=(spill_vector&& other) noexcept {
+        if (this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+
+    void swap(spill_vector& other) noexcept {
+        std::swap(m_budget, other.m_budget);
+        std::swap(m_size, other.m_size);
+        std::swap(m_capa, other.m_capa);
+        std::swap(m_data, other.m_data);
+        std::swap(m_fd, other.m_fd);
+    }
+
+    // Release the memory (the memory budget is kept).
+    void clear() {
+        if (m_fd >= 0) {
+            ::munmap(m_data, m_capa * sizeof(T));
+            ::close(m_fd);
+        } else {
+            std::free(m_data);
+        }
+        m_size = 0;
+        m_capa = 0;
+        m_data = nullptr;
+        m_fd = -1;
+    }
+
+    inline void set_budget(std::uint64_t budget) {
+        m_budget = budget;
+    }
+
+    inline std::uint64_t budget() const {
+        return m_budget;
+    }
+
+    inline bool is_spilled() const {
+        return m_fd >= 0;
+    }
+
+    inline void push_back(const T& x) {
+        if (m_size == m_capa) {
+            reallocate(m_capa == 0 ? 1 : m_capa * 2);
+        }
+        m_data[m_size++] = x;
+    }
+
+    inline void reserve(std::uint64_t capa) {
+        if (m_capa < capa) {
+            reallocate(capa);
+        }
+    }
+
+    inline void resize(std::uint64_t size, const T& x = T{}) {
+        reserve(size);
+        for (std::uint64_t i = m_size; i < size; i++) {
+            m_data[i] = x;
+        }
+        m_size = size;
+    }
+
+    inline T& operator[](std::uint64_t i) {
+        assert(i < m_size);
+        return m_data[i];
+    }
+    inline const T& operator[](std::uint64_t i) const {
+        assert(i < m_size);
+        return m_data[i];
+    }
+
+    inline T& back() {
+        assert(m_size != 0);
+        return m_data[m_size - 1];
+    }
+    inline const T& back() const {
+        assert(m_size != 0);
+        return m_data[m_size - 1];
+    }
+
+    inline T* begin() {
+        return m_data;
+    }
+    inline T* end() {
+        return m_data + m_size;
+    }
+    inline const T* begin() const {
+        return m_data;
+    }
+    inline const T* end() const {
+        return m_data + m_size;
+    }
+
+    inline T* data() {
+        return m_data;
+    }
+    inline const T* data() const {
+        return m_data;
+    }
+
+    inline std::uint64_t size() const {
+        return m_size;
+    }
+
+    inline std::uint64_t capacity() const {
+        return m_capa;
+    }
+
+    inline bool empty() const {
+        return m_size == 0;
+    }
+
+  private:
+    void reallocate(std::uint64_t capa) {
+        const std::uint64_t bytes = capa * sizeof(T);
+
+        if (m_fd < 0 && bytes <= m_budget) {
+            T* data = static_cast<T*>(std::realloc(static_cast<void*>(m_data), bytes));
+            XCDAT_THROW_IF(data == nullptr, "Failed to allocate memory.");
+            m_data = data;
+            m_capa = capa;
+            return;
+        }
+
+        if (m_fd < 0) {
+            // Spill the elements on the heap
+            const int fd = make_temporary_file();
+            XCDAT_THROW_IF(::ftruncate(fd, static_cast<off_t>(bytes)) != 0, "Failed to extend a temporary file.");
+            T* data = map_file(fd, bytes);
+            if (m_size != 0) {
+                std::memcpy(static_cast<void*>(data), static_cast<const void*>(m_data), m_size * sizeof(T));
+            }
+            std::free(m_data);
+            m_data = data;
+            m_fd = fd;
+        } else {
+            XCDAT_THROW_IF(::ftruncate(m_fd, static_cast<off_t>(bytes)) != 0, "Failed to extend a temporary file.");
+            ::munmap(m_data, m_capa * sizeof(T));
+            m_data = map_file(m_fd, bytes);
+        }
+        m_capa = capa;
+    }
+
+    static T* map_file(int fd, std::uint64_t bytes) {
+        void* addr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        XCDAT_THROW_IF(addr == MAP_FAILED, "Failed to map a temporary file.");
+        return static_cast<T*>(addr);
+    }
+
+    // Make a temporary file removed on closing.
+    static int make_temporary_file() {
+        std::string path = (std::filesystem::temp_directory_path() / "xcdat.XXXXXX").string();
+        const int fd = ::mkstemp(path.data());
+        XCDAT_THROW_IF(fd < 0, "Failed to make a temporary file.");
+        ::unlink(path.c_str());
+        return fd;
+    }
+};
+
+}  // namespace xcdat
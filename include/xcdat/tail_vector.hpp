@@ -7,9 +7,26 @@
 #include <string_view>
 #include <vector>
 
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// The number of bytes compared at once in the TAIL
+#if defined(__AVX2__)
+#define XCDAT_TAIL_CHUNK_SIZE 32
+#elif defined(__SSE4_2__)
+#define XCDAT_TAIL_CHUNK_SIZE 16
+#endif
+
 #include "bit_vector.hpp"
 #include "exception.hpp"
 #include "immutable_vector.hpp"
+#include "spill_vector.hpp"
+#include "thread_tools.hpp"
 
 namespace xcdat {
 
@@ -44,7 +61,7 @@ class tail_vector {
     class builder {
       private:
         // Buffer
-        std::vector<suffix_type> m_suffixes;
+        spill_vector<suffix_type> m_suffixes;
 
         // Released
         std::vector<char> m_chars;
@@ -54,6 +71,9 @@ class tail_vector {
         builder() = default;
         virtual ~builder() = default;
 
+        // The buffer of suffixes is spilled to a temporary file if its size exceeds memory_budget bytes.
+        explicit builder(std::uint64_t memory_budget) : m_suffixes(memory_budget) {}
+
         builder(const builder&) = delete;
         builder& operator=(const builder&) = delete;
 
@@ -65,51 +85,136 @@ class tail_vector {
             m_suffixes.push_back({str, npos});
         }
 
-        // setter(npos, tpos): Set units[npos].base = tpos.
-        void complete(bool bin_mode, const std::function<void(std::uint64_t, std::uint64_t)>& setter) {
-            std::sort(m_suffixes.begin(), m_suffixes.end(), [](const suffix_type& a, const suffix_type& b) {
-                return std::lexicographical_compare(std::rbegin(a), std::rend(a), std::rbegin(b), std::rend(b));
-            });
+        // Append the suffixes set to the other builder, whose npos are shifted by 'offset'.
+        void append(const builder& other, std::uint64_t offset) {
+            m_suffixes.reserve(m_suffixes.size() + other.m_suffixes.size());
+            for (const suffix_type& suffix : other.m_suffixes) {
+                m_suffixes.push_back({suffix.str, suffix.npos + offset});
+            }
+        }
 
-            // Dummy for an empty suffix
-            m_chars.emplace_back('\0');
-            if (bin_mode) {
-                m_terms.push_back(false);
+        // An upper bound of the TAIL positions given by complete().
+        std::uint64_t max_tpos() const {
+            std::uint64_t num_chars = 1;
+            for (const suffix_type& suffix : m_suffixes) {
+                num_chars += suffix.size() + 1;
             }
+            return num_chars;
+        }
 
-            const suffix_type dmmy_suffix = {{nullptr, 0}, 0};
-            const suffix_type* prev_suffix = &dmmy_suffix;
+        // setter(npos, tpos): Set units[npos].base = tpos.
+        // If num_threads > 1, the suffixes are processed in parallel and the setter is called concurrently
+        // (for different npos). The result is identical to that with num_threads = 1.
+        void complete(bool bin_mode, const std::function<void(std::uint64_t, std::uint64_t)>& setter,
+                      std::uint32_t num_threads = 1) {
+            complete<const std::function<void(std::uint64_t, std::uint64_t)>&>(bin_mode, setter, num_threads);
+        }
 
-            std::uint64_t prev_tpos = 0;
+        // The same as above, but the setter is inlined.
+        template <class Setter>
+        void complete(bool bin_mode, Setter&& setter, std::uint32_t num_threads = 1) {
+            thread_tools::sort(
+                m_suffixes.begin(), m_suffixes.end(),
+                [](const suffix_type& a, const suffix_type& b) {
+                    return std::lexicographical_compare(std::rbegin(a), std::rend(a), std::rbegin(b), std::rend(b));
+                },
+                num_threads);
+
+            // The suffixes are processed in the reverse order, i.e., the k-th one is m_suffixes[size - k - 1].
+            // A suffix is shared if it is a suffix of the previous one (except for the first one);
+            // otherwise, it is appended to the TAIL vector.
+            const std::uint64_t num_suffixes = m_suffixes.size();
+            auto get_suffix = [&](std::uint64_t k) -> const suffix_type& { return m_suffixes[num_suffixes - k - 1]; };
+
+            // The chunks of suffixes processed in parallel
+            struct chunk_type {
+                std::uint64_t beg = 0;
+                std::uint64_t end = 0;
+                std::uint64_t append_length = 0;  // Total length of the appended suffixes
+                std::uint64_t last_append = UINT64_MAX;  // The last appended suffix
+                std::uint64_t tpos = 0;  // The TAIL position of the first appended suffix
+                std::uint64_t anchor = UINT64_MAX;  // The last appended suffix in the previous chunks
+                std::uint64_t anchor_tpos = 0;
+            };
+            std::vector<chunk_type> chunks(num_threads == 0 ? 1 : num_threads);
+            std::vector<std::uint8_t> shared_flags(num_suffixes);  // Not std::vector<bool> to be written in parallel
+
+            thread_tools::run(chunks.size(), [&](std::uint32_t t) {
+                chunk_type& chunk = chunks[t];
+                chunk.beg = num_suffixes * t / chunks.size();
+                chunk.end = num_suffixes * (t + 1) / chunks.size();
+
+                for (std::uint64_t k = chunk.beg; k < chunk.end; k++) {
+                    const suffix_type& curr_suffix = get_suffix(k);
+                    XCDAT_THROW_IF(curr_suffix.size() == 0, "A suffix is empty.");
+
+                    bool shared = false;
+                    if (k != 0) {
+                        const suffix_type& prev_suffix = get_suffix(k - 1);
+                        std::uint64_t match = 0;
+                        while ((match < curr_suffix.size()) && (match < prev_suffix.size()) &&
+                               (prev_suffix[match] == curr_suffix[match])) {
+                            ++match;
+                        }
+                        shared = match == curr_suffix.size();
+                    }
 
-            for (std::uint64_t i = m_suffixes.size(); i > 0; --i) {
-                const suffix_type& curr_suffix = m_suffixes[i - 1];
-                XCDAT_THROW_IF(curr_suffix.size() == 0, "A suffix is empty.");
+                    shared_flags[k] = shared;
+                    if (!shared) {
+                        chunk.append_length += curr_suffix.size() + (bin_mode ? 0 : 1);
+                        chunk.last_append = k;
+                    }
+                }
+            });
 
-                std::uint64_t match = 0;
-                while ((match < curr_suffix.size()) && (match < prev_suffix->size()) &&
-                       ((*prev_suffix)[match] == curr_suffix[match])) {
-                    ++match;
+            // Dummy for an empty suffix
+            std::uint64_t num_chars = 1;
+            {
+                std::uint64_t anchor = UINT64_MAX, anchor_tpos = 0;
+                for (chunk_type& chunk : chunks) {
+                    chunk.tpos = num_chars;
+                    chunk.anchor = anchor;
+                    chunk.anchor_tpos = anchor_tpos;
+                    if (chunk.last_append != UINT64_MAX) {
+                        anchor = chunk.last_append;
+                        anchor_tpos = num_chars + chunk.append_length - get_suffix(anchor).size() - (bin_mode ? 0 : 1);
+                    }
+                    num_chars += chunk.append_length;
                 }
+            }
 
-                if ((match == curr_suffix.size()) && (prev_suffix->size() != 0)) {  // sharable
-                    setter(curr_suffix.npos, prev_tpos + (prev_suffix->size() - match));
-                    prev_tpos += prev_suffix->size() - match;
-                } else {  // append
-                    setter(curr_suffix.npos, m_chars.size());
-                    prev_tpos = m_chars.size();
-                    std::copy(curr_suffix.begin(), curr_suffix.end(), std::back_inserter(m_chars));
-                    if (bin_mode) {
-                        for (std::uint64_t j = 1; j < curr_suffix.size(); ++j) {
-                            m_terms.push_back(false);
-                        }
-                        m_terms.push_back(true);
-                    } else {
-                        m_chars.emplace_back('\0');
+            m_chars.resize(num_chars, '\0');
+
+            thread_tools::run(chunks.size(), [&](std::uint32_t t) {
+                const chunk_type& chunk = chunks[t];
+
+                std::uint64_t tpos = chunk.tpos;
+                std::uint64_t anchor = chunk.anchor;
+                std::uint64_t anchor_tpos = chunk.anchor_tpos;
+
+                for (std::uint64_t k = chunk.beg; k < chunk.end; k++) {
+                    const suffix_type& curr_suffix = get_suffix(k);
+                    if (shared_flags[k]) {  // sharable
+                        setter(curr_suffix.npos, anchor_tpos + (get_suffix(anchor).size() - curr_suffix.size()));
+                    } else {  // append
+                        setter(curr_suffix.npos, tpos);
+                        std::copy(curr_suffix.begin(), curr_suffix.end(), m_chars.begin() + tpos);
+                        anchor = k;
+                        anchor_tpos = tpos;
+                        tpos += curr_suffix.size() + (bin_mode ? 0 : 1);
                     }
                 }
+            });
 
-                prev_suffix = &curr_suffix;
+            if (bin_mode) {
+                m_terms.resize(num_chars);
+                std::uint64_t tpos = 1;
+                for (std::uint64_t k = 0; k < num_suffixes; k++) {
+                    if (!shared_flags[k]) {
+                        tpos += get_suffix(k).size();
+                        m_terms.set_bit(tpos - 1, true);
+                    }
+                }
             }
         }
 
@@ -144,7 +249,20 @@ class tail_vector {
         std::uint64_t kpos = 0;
 
         if (bin_mode()) {
-            do {
+#ifdef XCDAT_TAIL_CHUNK_SIZE
+            // Skip the chunks without mismatches or terminals.
+            while (kpos + chunk_size <= key.size() && tpos + chunk_size <= size()) {
+                const std::uint64_t neqs = mismatch_chunk(key.data() + kpos, tpos);
+                const std::uint64_t stops = neqs | m_terms.get_bits(tpos, chunk_size);
+                if (stops != 0) {
+                    const std::uint64_t j = bit_tools::lsb(stops);
+                    return ((neqs >> j) & 1ULL) == 0 && kpos + j + 1 == key.size();
+                }
+                kpos += chunk_size;
+                tpos += chunk_size;
+            }
+#endif
+            while (kpos < key.size()) {
                 if (key[kpos] != m_chars[tpos]) {
                     return false;
                 }
@@ -153,16 +271,26 @@ class tail_vector {
                     return kpos == key.size();
                 }
                 tpos += 1;
-            } while (kpos < key.size());
+            }
             return false;
         } else {
-            do {
+#ifdef XCDAT_TAIL_CHUNK_SIZE
+            // Skip the chunks without mismatches or terminators.
+            while (kpos + chunk_size <= key.size() && tpos + chunk_size <= size()) {
+                if ((mismatch_chunk(key.data() + kpos, tpos) | nul_chunk(tpos)) != 0) {
+                    return false;
+                }
+                kpos += chunk_size;
+                tpos += chunk_size;
+            }
+#endif
+            while (kpos < key.size()) {
                 if (!m_chars[tpos] || key[kpos] != m_chars[tpos]) {
                     return false;
                 }
                 kpos += 1;
                 tpos += 1;
-            } while (kpos < key.size());
+            }
             return !m_chars[tpos];
         }
     }
@@ -180,7 +308,22 @@ class tail_vector {
 
         std::uint64_t kpos = 0;
         if (bin_mode()) {
-            do {
+#ifdef XCDAT_TAIL_CHUNK_SIZE
+            while (kpos + chunk_size <= key.size() && tpos + chunk_size <= size()) {
+                const std::uint64_t neqs = mismatch_chunk(key.data() + kpos, tpos);
+                const std::uint64_t stops = neqs | m_terms.get_bits(tpos, chunk_size);
+                if (stops != 0) {
+                    const std::uint64_t j = bit_tools::lsb(stops);
+                    if ((neqs >> j) & 1ULL) {
+                        return std::nullopt;
+                    }
+                    return kpos + j + 1;
+                }
+                kpos += chunk_size;
+                tpos += chunk_size;
+            }
+#endif
+            while (kpos < key.size()) {
                 if (key[kpos] != m_chars[tpos]) {
                     return std::nullopt;
                 }
@@ -189,10 +332,25 @@ class tail_vector {
                     return kpos;
                 }
                 tpos += 1;
-            } while (kpos < key.size());
+            }
             return kpos;
         } else {
-            do {
+#ifdef XCDAT_TAIL_CHUNK_SIZE
+            while (kpos + chunk_size <= key.size() && tpos + chunk_size <= size()) {
+                const std::uint64_t nuls = nul_chunk(tpos);
+                const std::uint64_t stops = mismatch_chunk(key.data() + kpos, tpos) | nuls;
+                if (stops != 0) {
+                    const std::uint64_t j = bit_tools::lsb(stops);
+                    if ((nuls >> j) & 1ULL) {
+                        return kpos + j;
+                    }
+                    return std::nullopt;
+                }
+                kpos += chunk_size;
+                tpos += chunk_size;
+            }
+#endif
+            while (kpos < key.size()) {
                 if (!m_chars[tpos]) {
                     return kpos;
                 }
@@ -201,22 +359,39 @@ class tail_vector {
                 }
                 kpos += 1;
                 tpos += 1;
-            } while (kpos < key.size());
+            }
             return kpos;
         }
     }
 
+    // Returns true if key is a prefix of TAIL[tpos..], where the empty TAIL at tpos = 0 has only the empty prefix.
+    inline bool predictive_match(std::string_view key, std::uint64_t tpos) const {
+        const auto matched = prefix_match(key, tpos);
+        return matched && *matched == key.size();
+    }
+
     inline void decode(std::uint64_t tpos, const std::function<void(char)>& fn) const {
+        if (bin_mode() && tpos == 0) {
+            return;
+        }
+        const std::uint64_t epos = suffix_end(tpos);
+        for (; tpos < epos; ++tpos) {
+            fn(m_chars[tpos]);
+        }
+    }
+
+    // Append the suffix starting at tpos to decoded with one copy.
+    inline void decode(std::uint64_t tpos, std::string& decoded) const {
+        if (bin_mode() && tpos == 0) {
+            return;
+        }
+        decoded.append(m_chars.data() + tpos, suffix_end(tpos) - tpos);
+    }
+
+    inline void prefetch(std::uint64_t tpos) const {
+        __builtin_prefetch(m_chars.data() + tpos);
         if (bin_mode()) {
-            if (tpos != 0) {
-                do {
-                    fn(m_chars[tpos]);
-                } while (!m_terms[tpos++]);
-            }
-        } else {
-            while (m_chars[tpos]) {
-                fn(m_chars[tpos++]);
-            }
+            m_terms.prefetch(tpos);
         }
     }
 
@@ -229,6 +404,65 @@ class tail_vector {
         visitor.visit(m_chars);
         visitor.visit(m_terms);
     }
+
+  private:
+#ifdef XCDAT_TAIL_CHUNK_SIZE
+    static constexpr std::uint64_t chunk_size = XCDAT_TAIL_CHUNK_SIZE;
+
+    // Compare x[0..chunk_size) with TAIL[tpos..tpos+chunk_size), and return the bitmask of the mismatched bytes.
+    inline std::uint64_t mismatch_chunk(const char* x, std::uint64_t tpos) const {
+#ifdef __AVX2__
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_chars.data() + tpos));
+        return ~static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+#else
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_chars.data() + tpos));
+        return ~static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) & 0xFFFFU;
+#endif
+    }
+
+    // Return the bitmask of the NUL bytes in TAIL[tpos..tpos+chunk_size).
+    inline std::uint64_t nul_chunk(std::uint64_t tpos) const {
+#ifdef __AVX2__
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_chars.data() + tpos));
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, _mm256_setzero_si256())));
+#else
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_chars.data() + tpos));
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(b, _mm_setzero_si128())));
+#endif
+    }
+#endif
+
+    // Return the end position (exclusive) of the suffix starting at tpos (> 0 in binary mode).
+    inline std::uint64_t suffix_end(std::uint64_t tpos) const {
+        if (bin_mode()) {
+            while (tpos + 64 <= size()) {
+                const std::uint64_t terms = m_terms.get_bits(tpos, 64);
+                if (terms != 0) {
+                    return tpos + bit_tools::lsb(terms) + 1;
+                }
+                tpos += 64;
+            }
+            while (!m_terms[tpos]) {
+                tpos += 1;
+            }
+            return tpos + 1;
+        }
+#ifdef XCDAT_TAIL_CHUNK_SIZE
+        while (tpos + chunk_size <= size()) {
+            const std::uint64_t nuls = nul_chunk(tpos);
+            if (nuls != 0) {
+                return tpos + bit_tools::lsb(nuls);
+            }
+            tpos += chunk_size;
+        }
+#endif
+        while (m_chars[tpos]) {
+            tpos += 1;
+        }
+        return tpos;
+    }
 };
 
 }  // namespace xcdat
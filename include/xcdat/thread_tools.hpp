@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace xcdat::thread_tools {
+
+// Run fn(t) for each t in [0,num_threads) on its own thread, and wait for all of them.
+// If some of them throw exceptions, the first one (in the order of t) is rethrown.
+template <class Fn>
+void run(std::uint32_t num_threads, Fn&& fn) {
+    if (num_threads <= 1) {
+        fn(std::uint32_t(0));
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(num_threads);
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+
+    for (std::uint32_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            try {
+                fn(t);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+// Run fn(beg, end) for the num_threads ranges evenly partitioning [0,size) in parallel.
+template <class Fn>
+void run_ranges(std::uint32_t num_threads, std::uint64_t size, Fn&& fn) {
+    run(num_threads, [&](std::uint32_t t) {
+        const std::uint64_t beg = size * t / num_threads;
+        const std::uint64_t end = size * (t + 1) / num_threads;
+        if (beg < end) {
+            fn(beg, end);
+        }
+    });
+}
+
+// Sort [first,last) by sorting num_threads parts in parallel and merging them pairwise in parallel.
+template <class RandomIt, class Compare>
+void sort(RandomIt first, RandomIt last, Compare comp, std::uint32_t num_threads) {
+    const auto size = static_cast<std::uint64_t>(std::distance(first, last));
+    if (num_threads <= 1 || size < num_threads) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    std::vector<std::uint64_t> bounds(num_threads + 1);
+    for (std::uint32_t t = 0; t <= num_threads; t++) {
+        bounds[t] = size * t / num_threads;
+    }
+
+    run(num_threads, [&](std::uint32_t t) { std::sort(first + bounds[t], first + bounds[t + 1], comp); });
+
+    for (std::uint32_t step = 1; step < num_threads; step *= 2) {
+        const std::uint32_t num_merges = (num_threads + step * 2 - 1) / (step * 2);
+        run(num_merges, [&](std::uint32_t m) {
+            const std::uint32_t t = m * step * 2;
+            if (t + step < num_threads) {
+                const std::uint32_t u = std::min(t + step * 2, num_threads);
+                std::inplace_merge(first + bounds[t], first + bounds[t + step], first + bounds[u], comp);
+            }
+        });
+    }
+}
+
+}  // namespace xcdat::thread_tools
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <array>
 #include <functional>
+#include <numeric>
 #include <optional>
 #include <string>
 #include <string_view>
 
+#include "compact_vector.hpp"
 #include "trie_builder.hpp"
 
 namespace xcdat {
@@ -18,14 +21,27 @@ class trie {
     using bc_vector_type = BcVector;
 
     //! The type identifier.
-    static constexpr std::uint32_t type_id = bc_vector_type::l1_bits;
+    static constexpr std::uint32_t type_id = bc_vector_type::type_id;
+
+    //! The number of queries traversed in lockstep by the batch operations.
+    static constexpr std::uint64_t batch_size = 16;
+
+    //! The magic word with the format version written at the beginning of the dictionary.
+    //! The files of older versions start with the number of keywords instead and are rejected.
+    static constexpr std::uint64_t format_magic = 0x5844434154000002ULL;
 
   private:
+    std::uint64_t m_format = format_magic;
     std::uint64_t m_num_keys = 0;
     code_table m_table;
     bit_vector m_terms;
     bc_vector_type m_bcvec;
     tail_vector m_tvec;
+    immutable_vector<std::uint8_t> m_label_links;  // optional, see build_label_links()
+    compact_vector m_scores;  // optional, see build_scores()
+    compact_vector m_max_scores;  // optional, see build_scores()
+    compact_vector m_sorted_ids;  // optional, see build_sorted_ids()
+    compact_vector m_sorted_npos;  // optional, see build_sorted_ids()
 
   public:
     //! Default constructor
@@ -59,8 +75,17 @@ class trie {
     //!  - begin() returns the iterator to the beginning.
     //!  - end() returns the iterator to the end.
     //! The type 'Strings::value_type::value_type' should be one-byte integer type such as 'char'.
+    //!
+    //! If num_threads > 1, the subtries are arranged in parallel.
+    //! The resulting trie may differ from that built with num_threads = 1 (e.g., in assigned IDs),
+    //! but supports the same operations.
+    //!
+    //! If the construction buffers exceed memory_budget bytes, they are spilled to temporary files.
+    //! To build a dictionary larger than RAM, give the keys by xcdat::key_file.
     template <class Strings>
-    trie(const Strings& keys, bool bin_mode = false) : trie(trie_builder(keys, bc_vector_type::l1_bits, bin_mode)) {
+    trie(const Strings& keys, bool bin_mode = false, std::uint32_t num_threads = 1,
+         std::uint64_t memory_budget = UINT64_MAX)
+        : trie(trie_builder(keys, bc_vector_type::l1_bits, bin_mode, num_threads, memory_budget)) {
         static_assert(sizeof(char) == sizeof(typename Strings::value_type::value_type));
     }
 
@@ -99,6 +124,170 @@ class trie {
         return m_bcvec.num_free_units();
     }
 
+    //! Build the label links to visit only the existing children in predictive search and enumeration,
+    //! instead of testing every character of the alphabet. They use two bytes per DA unit:
+    //! the code of the child with the largest label, and the code of the sibling with the next smaller label.
+    void build_label_links(std::uint32_t num_threads = 1) {
+        const std::uint64_t num_units = m_bcvec.num_units();
+        std::vector<std::uint8_t> links(num_units * 2);
+
+        // Since the children of a node are in the same block of 256 units, the blocks are processed independently.
+        thread_tools::run_ranges(num_threads, (num_units + 255) / 256, [&](std::uint64_t beg, std::uint64_t end) {
+            struct child_type {
+                std::uint64_t ppos;
+                std::uint64_t cpos;
+                std::uint8_t label;
+                std::uint8_t code;
+            };
+            std::vector<child_type> children;
+
+            for (std::uint64_t bpos = beg; bpos < end; ++bpos) {
+                children.clear();
+                for (std::uint64_t cpos = bpos * 256; cpos < std::min(bpos * 256 + 256, num_units); ++cpos) {
+                    if (cpos != 0 && m_bcvec.is_used(cpos)) {
+                        const std::uint64_t ppos = m_bcvec.check(cpos);
+                        const auto code = static_cast<std::uint8_t>(m_bcvec.base(ppos) ^ cpos);
+                        children.push_back({ppos, cpos, static_cast<std::uint8_t>(m_table.get_char(code)), code});
+                    }
+                }
+                std::sort(children.begin(), children.end(), [](const child_type& a, const child_type& b) {
+                    return a.ppos != b.ppos ? a.ppos < b.ppos : a.label < b.label;
+                });
+
+                for (std::uint64_t i = 0; i < children.size(); ++i) {
+                    const bool is_first = i == 0 || children[i - 1].ppos != children[i].ppos;
+                    links[children[i].cpos * 2 + 1] = is_first ? children[i].code : children[i - 1].code;
+                    if (i + 1 == children.size() || children[i + 1].ppos != children[i].ppos) {
+                        links[children[i].ppos * 2] = children[i].code;
+                    }
+                }
+            }
+        });
+
+        m_label_links.build(links);
+    }
+
+    //! Check if the label links are built.
+    inline bool has_label_links() const {
+        return m_label_links.size() != 0;
+    }
+
+    //! Get the memory usage of the label links in bytes.
+    inline std::uint64_t label_links_memory_in_bytes() const {
+        return m_label_links.memory_in_bytes();
+    }
+
+    //! Build the order-preserving IDs, with which the ID of a keyword is its rank in lexicographical order,
+    //! i.e., 'lookup(keys[i]) == i' for the sorted keywords given in the construction.
+    //! The IDs are mapped from and to the DA units through two compact permutations of
+    //! log(num_keys) + log(num_units) bits per keyword. The scores are kept if already built.
+    void build_sorted_ids() {
+        if (num_keys() == 0) {
+            return;
+        }
+
+        // Visit the terms in lexicographical order, where a term precedes the keywords in its subtree.
+        std::vector<std::uint64_t> sorted_ids(num_keys());
+        std::vector<std::uint64_t> sorted_npos(num_keys());
+        std::vector<typename predictive_iterator::cursor_type> stack = {{'\0', 0, 0}};
+        std::vector<std::uint64_t> scores(has_scores() ? num_keys() : 0);
+        std::uint64_t sorted_id = 0;
+
+        while (!stack.empty()) {
+            const std::uint64_t npos = stack.back().npos;
+            const std::uint64_t kpos = stack.back().kpos;
+            stack.pop_back();
+
+            if (m_terms[npos]) {
+                if (has_scores()) {
+                    scores[sorted_id] = score(npos_to_id(npos));  // by the current ID
+                }
+                sorted_ids[m_terms.rank(npos)] = sorted_id;
+                sorted_npos[sorted_id] = npos;
+                sorted_id += 1;
+            }
+            if (!m_bcvec.is_leaf(npos)) {
+                push_children(stack, npos, kpos);
+            }
+        }
+        assert(sorted_id == num_keys());
+
+        m_sorted_ids = compact_vector(sorted_ids);
+        m_sorted_npos = compact_vector(sorted_npos);
+        if (has_scores()) {
+            m_scores = compact_vector(scores);
+        }
+    }
+
+    //! Check if the order-preserving IDs are built.
+    inline bool has_sorted_ids() const {
+        return m_sorted_ids.size() != 0;
+    }
+
+    //! Get the memory usage of the order-preserving IDs in bytes.
+    inline std::uint64_t sorted_ids_memory_in_bytes() const {
+        return m_sorted_ids.memory_in_bytes() + m_sorted_npos.memory_in_bytes();
+    }
+
+    //! Build the scores for top-k predictive search, where 'scores[i]' is the score of 'keys[i]'
+    //! and a larger score is ranked higher. 'keys' should be the keywords given in the construction.
+    //! In addition to the score of each ID, the maximum score in the subtree is stored for each DA unit,
+    //! so that predictive_topk() visits only the subtrees that can contain the best completions.
+    template <class Strings, class Scores>
+    void build_scores(const Strings& keys, const Scores& scores, std::uint32_t num_threads = 1) {
+        XCDAT_THROW_IF(keys.size() != num_keys(), "The number of keywords is different from the trie.");
+        XCDAT_THROW_IF(scores.size() != num_keys(), "The number of scores is different from the trie.");
+
+        std::vector<std::uint64_t> key_scores(num_keys());
+        thread_tools::run_ranges(num_threads, num_keys(), [&](std::uint64_t beg, std::uint64_t end) {
+            for (std::uint64_t i = beg; i < end; ++i) {
+                const auto& key = keys[i];
+                const auto id = lookup(std::string_view(key.data(), key.size()));
+                XCDAT_THROW_IF(!id.has_value(), "The keyword is not stored in the trie.");
+                key_scores[id.value()] = scores[i];
+            }
+        });
+
+        // Propagate the scores upward in decreasing order, so that each node is written once by its best keyword.
+        std::vector<std::uint64_t> ids(num_keys());
+        std::iota(ids.begin(), ids.end(), 0);
+        thread_tools::sort(
+            ids.begin(), ids.end(), [&](std::uint64_t a, std::uint64_t b) { return key_scores[a] > key_scores[b]; },
+            num_threads);
+
+        std::vector<std::uint64_t> max_scores(m_bcvec.num_units());
+        bit_vector::builder visited(m_bcvec.num_units());
+        for (const std::uint64_t id : ids) {
+            std::uint64_t npos = id_to_npos(id);
+            while (!visited[npos]) {
+                visited.set_bit(npos);
+                max_scores[npos] = key_scores[id];
+                if (npos == 0) {
+                    break;
+                }
+                npos = m_bcvec.check(npos);
+            }
+        }
+
+        m_scores = compact_vector(key_scores);
+        m_max_scores = compact_vector(max_scores);
+    }
+
+    //! Check if the scores are built.
+    inline bool has_scores() const {
+        return m_scores.size() != 0;
+    }
+
+    //! Get the score of the ID, which should be built by build_scores().
+    inline std::uint64_t score(std::uint64_t id) const {
+        return m_scores[id];
+    }
+
+    //! Get the memory usage of the scores in bytes.
+    inline std::uint64_t scores_memory_in_bytes() const {
+        return m_scores.memory_in_bytes() + m_max_scores.memory_in_bytes();
+    }
+
     //! Get the length of TAIL vector.
     inline std::uint64_t tail_length() const {
         return m_tvec.size();
@@ -128,6 +317,33 @@ class trie {
         return npos_to_id(npos);
     }
 
+    //! Lookup the IDs of 'size' keywords in a batch and store them in 'ids[0..size)'.
+    //! The result is the same as 'ids[i] = lookup(keys[i])', but the traversals of every batch_size keywords
+    //! are interleaved and the next BC units and TAIL characters are prefetched to hide cache misses.
+    inline void lookup_batch(const std::string_view* keys, std::uint64_t size,
+                             std::optional<std::uint64_t>* ids) const {
+        std::array<lookup_cursor, batch_size> cursors;
+
+        for (std::uint64_t beg = 0; beg < size; beg += batch_size) {
+            const std::uint64_t end = std::min(beg + batch_size, size);
+
+            std::uint64_t num_actives = end - beg;
+            for (std::uint64_t i = 0; i < num_actives; i++) {
+                cursors[i] = lookup_cursor{};
+            }
+
+            while (num_actives != 0) {
+                for (std::uint64_t i = beg; i < end; i++) {
+                    lookup_cursor& cur = cursors[i - beg];
+                    if (!cur.is_end && next_lookup(keys[i], cur, ids[i])) {
+                        cur.is_end = true;
+                        num_actives -= 1;
+                    }
+                }
+            }
+        }
+    }
+
     //! Decode the keyword associated with the ID.
     inline std::string decode(std::uint64_t id) const {
         std::string decoded;
@@ -156,10 +372,62 @@ class trie {
 
         std::reverse(decoded.begin(), decoded.end());
         if (tpos != 0 && tpos != UINT64_MAX) {
-            m_tvec.decode(tpos, [&](char c) { decoded.push_back(c); });
+            m_tvec.decode(tpos, decoded);
         }
     }
 
+    //! Decode the keywords associated with 'size' IDs in a batch.
+    //! The keywords are concatenated into 'decoded', and the keyword of 'ids[i]' is stored in
+    //! 'decoded[offsets[i]..offsets[i+1])', where 'offsets' should have 'size + 1' elements.
+    //! The result is the same as 'decode(ids[i])', but the upward traversals of every batch_size IDs
+    //! are interleaved and the next BC units are prefetched to hide cache misses.
+    inline void decode_batch(const std::uint64_t* ids, std::uint64_t size, std::string& decoded,
+                             std::uint64_t* offsets) const {
+        std::array<decode_cursor, batch_size> cursors;
+        std::string reversed(batch_size * max_length(), '\0');  // Labels collected in the traversals
+
+        decoded.clear();
+
+        for (std::uint64_t beg = 0; beg < size; beg += batch_size) {
+            const std::uint64_t end = std::min(beg + batch_size, size);
+
+            std::uint64_t num_actives = 0;
+            for (std::uint64_t i = beg; i < end; i++) {
+                decode_cursor& cur = cursors[i - beg];
+                cur = decode_cursor{};
+                if (ids[i] < num_keys()) {
+                    cur.npos = id_to_npos(ids[i]);
+                    m_bcvec.prefetch(cur.npos);
+                    num_actives += 1;
+                } else {
+                    cur.is_end = true;
+                }
+            }
+
+            while (num_actives != 0) {
+                for (std::uint64_t i = beg; i < end; i++) {
+                    decode_cursor& cur = cursors[i - beg];
+                    if (!cur.is_end && next_decode(cur, reversed.data() + (i - beg) * max_length())) {
+                        cur.is_end = true;
+                        num_actives -= 1;
+                    }
+                }
+            }
+
+            for (std::uint64_t i = beg; i < end; i++) {
+                const decode_cursor& cur = cursors[i - beg];
+                const char* labels = reversed.data() + (i - beg) * max_length();
+
+                offsets[i] = decoded.size();
+                decoded.append(std::make_reverse_iterator(labels + cur.length), std::make_reverse_iterator(labels));
+                if (cur.tpos != 0 && cur.tpos != UINT64_MAX) {
+                    m_tvec.decode(cur.tpos, decoded);
+                }
+            }
+        }
+        offsets[size] = decoded.size();
+    }
+
     //! An iterator class for common prefix search.
     //! It enumerates all the keywords contained as prefixes of a given string.
     //! It should be instantiated via the function 'make_prefix_iterator'.
@@ -212,6 +480,12 @@ class trie {
     //! Preform common prefix search for the keyword.
     inline void prefix_search(std::string_view key,
                               const std::function<void(std::uint64_t, std::string_view)>& fn) const {
+        prefix_search<const std::function<void(std::uint64_t, std::string_view)>&>(key, fn);
+    }
+
+    //! Preform common prefix search for the keyword, where 'fn(id, keyword)' is inlined.
+    template <class Fn>
+    inline void prefix_search(std::string_view key, Fn&& fn) const {
         auto itr = make_prefix_iterator(key);
         while (itr.next()) {
             fn(itr.id(), itr.decoded_view());
@@ -266,6 +540,17 @@ class trie {
       private:
         predictive_iterator(const trie_type* obj, std::string_view key) : m_obj(obj), m_key(key) {}
 
+        // Restart the iteration while keeping the capacities of the buffers.
+        inline void reset(const trie_type* obj, std::string_view key) {
+            m_obj = obj;
+            m_key = key;
+            m_id = 0;
+            m_decoded.clear();
+            m_stack.clear();
+            is_beg = true;
+            is_end = false;
+        }
+
         friend class trie;
     };
 
@@ -274,15 +559,57 @@ class trie {
         return predictive_iterator(this, key);
     }
 
+    //! Reset the predictive searcher to the keyword, reusing the buffers of 'itr'.
+    //! Once the buffers have grown enough, e.g., in a long-lived worker, no memory is allocated.
+    inline void reset_predictive_iterator(predictive_iterator& itr, std::string_view key) const {
+        itr.reset(this, key);
+    }
+
     //! Preform predictive search for the keyword.
     inline void predictive_search(std::string_view key,
                                   const std::function<void(std::uint64_t, std::string_view)>& fn) const {
+        predictive_search<const std::function<void(std::uint64_t, std::string_view)>&>(key, fn);
+    }
+
+    //! Preform predictive search for the keyword, where 'fn(id, keyword)' is inlined.
+    template <class Fn>
+    inline void predictive_search(std::string_view key, Fn&& fn) const {
         auto itr = make_predictive_iterator(key);
         while (itr.next()) {
             fn(itr.id(), itr.decoded_view());
         }
     }
 
+    //! Preform top-k predictive search for the keyword, and return the IDs of the (at most) k keywords
+    //! with the largest scores in decreasing order of the scores, where ties are broken arbitrarily.
+    //! The scores should be built by build_scores().
+    inline std::vector<std::uint64_t> predictive_topk(std::string_view key, std::uint64_t k) const {
+        std::vector<std::uint64_t> ids;
+        topk_ids(key, k, ids);
+        return ids;
+    }
+
+    //! Preform top-k predictive search for the keyword, where 'fn(id, keyword)' is called in decreasing order of
+    //! the scores.
+    inline void predictive_topk(std::string_view key, std::uint64_t k,
+                                const std::function<void(std::uint64_t, std::string_view)>& fn) const {
+        predictive_topk<const std::function<void(std::uint64_t, std::string_view)>&>(key, k, fn);
+    }
+
+    //! Preform top-k predictive search for the keyword, where 'fn(id, keyword)' is inlined.
+    template <class Fn>
+    inline void predictive_topk(std::string_view key, std::uint64_t k, Fn&& fn) const {
+        std::vector<std::uint64_t> ids;
+        topk_ids(key, k, ids);
+
+        std::string decoded;
+        decoded.reserve(max_length());
+        for (const std::uint64_t id : ids) {
+            decode(id, decoded);
+            fn(id, std::string_view(decoded));
+        }
+    }
+
     //! An iterator class for enumeration.
     //! It enumerates all the keywords stored in the trie.
     //! It should be instantiated via the function 'make_enumerative_iterator'.
@@ -293,40 +620,277 @@ class trie {
         return enumerative_iterator(this, "");
     }
 
+    //! Reset the enumerator, reusing the buffers of 'itr'.
+    inline void reset_enumerative_iterator(enumerative_iterator& itr) const {
+        itr.reset(this, "");
+    }
+
     //! Enumerate all the keywords and their IDs stored in the trie.
     inline void enumerate(const std::function<void(std::uint64_t, std::string_view)>& fn) const {
+        enumerate<const std::function<void(std::uint64_t, std::string_view)>&>(fn);
+    }
+
+    //! Enumerate all the keywords and their IDs stored in the trie, where 'fn(id, keyword)' is inlined.
+    template <class Fn>
+    inline void enumerate(Fn&& fn) const {
         auto itr = make_enumerative_iterator();
         while (itr.next()) {
             fn(itr.id(), itr.decoded_view());
         }
     }
 
+    //! Make the enumerator starting from the smallest keyword not less than 'key' in lexicographical order.
+    //! Unlike IDs, which follow the order of DA units, the enumerator visits the keywords in lexicographical order.
+    inline enumerative_iterator make_lower_bound_iterator(std::string_view key) const {
+        enumerative_iterator itr(this, key);
+        seek_bound(itr, true);
+        return itr;
+    }
+
+    //! Make the enumerator starting from the smallest keyword greater than 'key' in lexicographical order.
+    inline enumerative_iterator make_upper_bound_iterator(std::string_view key) const {
+        enumerative_iterator itr(this, key);
+        seek_bound(itr, false);
+        return itr;
+    }
+
+    //! Get the ID of the smallest keyword not less than 'key', or std::nullopt if not found.
+    inline std::optional<std::uint64_t> lower_bound(std::string_view key) const {
+        auto itr = make_lower_bound_iterator(key);
+        return itr.next() ? std::optional<std::uint64_t>(itr.id()) : std::nullopt;
+    }
+
+    //! Get the ID of the smallest keyword greater than 'key', or std::nullopt if not found.
+    inline std::optional<std::uint64_t> upper_bound(std::string_view key) const {
+        auto itr = make_upper_bound_iterator(key);
+        return itr.next() ? std::optional<std::uint64_t>(itr.id()) : std::nullopt;
+    }
+
+    //! Enumerate the keywords in [lo, hi) and their IDs in lexicographical order.
+    inline void range_search(std::string_view lo, std::string_view hi,
+                             const std::function<void(std::uint64_t, std::string_view)>& fn) const {
+        range_search<const std::function<void(std::uint64_t, std::string_view)>&>(lo, hi, fn);
+    }
+
+    //! Enumerate the keywords in [lo, hi) and their IDs in lexicographical order, where 'fn(id, keyword)' is inlined.
+    template <class Fn>
+    inline void range_search(std::string_view lo, std::string_view hi, Fn&& fn) const {
+        auto itr = make_lower_bound_iterator(lo);
+        while (itr.next() && itr.decoded_view() < hi) {
+            fn(itr.id(), itr.decoded_view());
+        }
+    }
+
     //! Visit the members (commonly used for I/O).
     template <class Visitor>
     void visit(Visitor& visitor) {
+        visitor.visit(m_format);
+        XCDAT_THROW_IF(m_format != format_magic, "The input dictionary is of an incompatible format version.");
         visitor.visit(m_num_keys);
         visitor.visit(m_table);
         visitor.visit(m_terms);
         visitor.visit(m_bcvec);
         visitor.visit(m_tvec);
+        visitor.visit(m_label_links);
+        visitor.visit(m_scores);
+        visitor.visit(m_max_scores);
+        visitor.visit(m_sorted_ids);
+        visitor.visit(m_sorted_npos);
     }
 
   private:
     template <class Strings>
     explicit trie(trie_builder<Strings>&& b)
         : m_num_keys(b.m_keys.size()), m_table(std::move(b.m_table)), m_terms(b.m_terms, true, true),
-          m_bcvec(b.m_units, std::move(b.m_leaves)), m_tvec(std::move(b.m_suffixes)) {}
+          m_bcvec(b.m_units, std::move(b.m_leaves), b.m_num_threads), m_tvec(std::move(b.m_suffixes)) {}
 
     static constexpr std::string_view get_suffix(std::string_view s, std::uint64_t i) {
         assert(i <= s.size());
         return s.substr(i, s.size() - i);
     }
 
+    struct lookup_cursor {
+        std::uint64_t kpos = 0;
+        std::uint64_t npos = 0;
+        std::uint64_t tpos = UINT64_MAX;  // UINT64_MAX until a leaf is reached
+        bool is_end = false;
+    };
+
+    // Perform one transition of lookup and prefetch the data accessed in the next transition.
+    // Return true if the lookup is terminated, where the result is set to 'id'.
+    inline bool next_lookup(std::string_view key, lookup_cursor& cur, std::optional<std::uint64_t>& id) const {
+        if (cur.tpos != UINT64_MAX) {
+            if (!m_tvec.match(get_suffix(key, cur.kpos), cur.tpos)) {
+                id = std::nullopt;
+            } else {
+                id = npos_to_id(cur.npos);
+            }
+            return true;
+        }
+
+        if (m_bcvec.is_leaf(cur.npos)) {
+            cur.tpos = m_bcvec.link(cur.npos);
+            m_tvec.prefetch(cur.tpos);
+            return false;
+        }
+
+        if (cur.kpos == key.size()) {
+            if (!m_terms[cur.npos]) {
+                id = std::nullopt;
+            } else {
+                id = npos_to_id(cur.npos);
+            }
+            return true;
+        }
+
+        const std::uint64_t cpos = m_bcvec.base(cur.npos) ^ m_table.get_code(key[cur.kpos++]);
+        if (m_bcvec.check(cpos) != cur.npos) {
+            id = std::nullopt;
+            return true;
+        }
+
+        cur.npos = cpos;
+        m_bcvec.prefetch(cur.npos);
+        m_terms.prefetch(cur.npos);
+        return false;
+    }
+
+    struct decode_cursor {
+        std::uint64_t npos = 0;
+        std::uint64_t ppos = UINT64_MAX;  // UINT64_MAX until the parent of npos is fetched
+        std::uint64_t tpos = UINT64_MAX;  // UINT64_MAX if the node is not a leaf
+        std::uint64_t length = 0;  // The number of collected labels
+        bool is_beg = true;
+        bool is_end = false;
+    };
+
+    // Perform a half step of the upward traversal for decode and prefetch the data accessed in the next half step.
+    // The labels are stored in 'labels' in reverse order. Return true if the root is reached.
+    inline bool next_decode(decode_cursor& cur, char* labels) const {
+        if (cur.is_beg) {
+            cur.is_beg = false;
+            if (m_bcvec.is_leaf(cur.npos)) {
+                cur.tpos = m_bcvec.link(cur.npos);
+                m_tvec.prefetch(cur.tpos);
+            }
+        }
+
+        if (cur.npos == 0) {
+            return true;
+        }
+
+        if (cur.ppos == UINT64_MAX) {
+            cur.ppos = m_bcvec.check(cur.npos);
+            m_bcvec.prefetch(cur.ppos);
+            return false;
+        }
+
+        labels[cur.length++] = m_table.get_char(m_bcvec.base(cur.ppos) ^ cur.npos);
+        cur.npos = cur.ppos;
+        cur.ppos = UINT64_MAX;
+        return cur.npos == 0;
+    }
+
+    struct topk_entry {
+        std::uint64_t score;
+        std::uint64_t npos;
+        bool is_term;  // for the keyword terminated at npos, or the subtree of npos
+
+        inline bool operator<(const topk_entry& rhs) const {
+            return score < rhs.score;
+        }
+    };
+
+    // Best-first search over the subtree of the key, where the entries are ordered by their (maximum) scores.
+    inline void topk_ids(std::string_view key, std::uint64_t k, std::vector<std::uint64_t>& ids) const {
+        XCDAT_THROW_IF(!has_scores(), "The scores are not built.");
+        ids.clear();
+
+        if (k == 0) {
+            return;
+        }
+
+        std::uint64_t npos = 0;
+        for (std::uint64_t kpos = 0; kpos < key.size(); ++kpos) {
+            if (m_bcvec.is_leaf(npos)) {
+                // The rest of the key must be a prefix of the TAIL, which fails for an empty TAIL.
+                if (m_tvec.predictive_match(get_suffix(key, kpos), m_bcvec.link(npos))) {
+                    ids.push_back(npos_to_id(npos));
+                }
+                return;
+            }
+            const std::uint64_t cpos = m_bcvec.base(npos) ^ m_table.get_code(key[kpos]);
+            if (m_bcvec.check(cpos) != npos) {
+                return;
+            }
+            npos = cpos;
+        }
+
+        std::vector<topk_entry> heap = {{m_max_scores[npos], npos, false}};
+
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end());
+            const topk_entry top = heap.back();
+            heap.pop_back();
+
+            if (top.is_term || m_bcvec.is_leaf(top.npos)) {
+                ids.push_back(npos_to_id(top.npos));
+                if (ids.size() == k) {
+                    return;
+                }
+                continue;
+            }
+
+            if (m_terms[top.npos]) {
+                heap.push_back({m_scores[npos_to_id(top.npos)], top.npos, true});
+                std::push_heap(heap.begin(), heap.end());
+            }
+
+            const std::uint64_t base = m_bcvec.base(top.npos);
+            if (has_label_links()) {
+                for (std::uint8_t code = m_label_links[top.npos * 2];;) {
+                    const std::uint64_t cpos = base ^ code;
+                    heap.push_back({m_max_scores[cpos], cpos, false});
+                    std::push_heap(heap.begin(), heap.end());
+                    const std::uint8_t next_code = m_label_links[cpos * 2 + 1];
+                    if (next_code == code) {
+                        break;
+                    }
+                    code = next_code;
+                }
+            } else {
+                for (auto cit = m_table.begin(); cit != m_table.end(); ++cit) {
+                    const std::uint64_t cpos = base ^ m_table.get_code(*cit);
+                    if (m_bcvec.check(cpos) == top.npos) {
+                        heap.push_back({m_max_scores[cpos], cpos, false});
+                        std::push_heap(heap.begin(), heap.end());
+                    }
+                }
+            }
+
+            // Every entry yields at least one keyword of its score, so only the best 'rest' entries are needed.
+            // They are trimmed when the heap doubles, to bound it by O(k) with amortized constant cost.
+            const std::uint64_t rest = k - ids.size();
+            if (heap.size() > rest * 2) {
+                std::nth_element(heap.begin(), heap.begin() + rest, heap.end(),
+                                 [](const topk_entry& a, const topk_entry& b) { return b < a; });
+                heap.resize(rest);
+                std::make_heap(heap.begin(), heap.end());
+            }
+        }
+    }
+
     inline std::uint64_t npos_to_id(std::uint64_t npos) const {
+        if (has_sorted_ids()) {
+            return m_sorted_ids[m_terms.rank(npos)];
+        }
         return m_terms.rank(npos);
     };
 
     inline std::uint64_t id_to_npos(std::uint64_t id) const {
+        if (has_sorted_ids()) {
+            return m_sorted_npos[id];
+        }
         return m_terms.select(id);
     };
 
@@ -337,7 +901,7 @@ class trie {
 
         if (itr->is_beg) {
             itr->is_beg = false;
-            if (m_terms[itr->m_npos]) {
+            if (!m_bcvec.is_leaf(itr->m_npos) && m_terms[itr->m_npos]) {  // The root can be a leaf with a suffix.
                 itr->m_id = npos_to_id(itr->m_npos);
                 return true;
             }
@@ -385,6 +949,78 @@ class trie {
         return true;
     }
 
+    // Push the children of the node with labels larger than 'min_label' onto the stack in decreasing order of the
+    // labels, so that they are popped in lexicographical order. All the children are pushed if min_label = -1.
+    inline void push_children(std::vector<typename predictive_iterator::cursor_type>& stack, std::uint64_t npos,
+                              std::uint64_t kpos, std::int32_t min_label = -1) const {
+        const std::uint64_t base = m_bcvec.base(npos);
+
+        if (has_label_links()) {
+            // Follow the children from the largest label, where the smallest one links to itself.
+            for (std::uint8_t code = m_label_links[npos * 2];;) {
+                const char label = m_table.get_char(code);
+                if (static_cast<std::uint8_t>(label) <= min_label) {
+                    break;
+                }
+                const std::uint64_t cpos = base ^ code;
+                stack.push_back({label, kpos + 1, cpos});
+                const std::uint8_t next_code = m_label_links[cpos * 2 + 1];
+                if (next_code == code) {
+                    break;
+                }
+                code = next_code;
+            }
+        } else {
+            for (auto cit = m_table.rbegin(); cit != m_table.rend() && min_label < *cit; ++cit) {
+                const std::uint64_t cpos = base ^ m_table.get_code(*cit);
+                if (m_bcvec.check(cpos) == npos) {
+                    stack.push_back({static_cast<char>(*cit), kpos + 1, cpos});
+                }
+            }
+        }
+    }
+
+    // Set up the enumerator to start from the smallest keyword not less than (or greater than, if !inclusive) its key.
+    // The siblings with larger labels along the path of the key are pushed, so that they are visited after the
+    // subtree on the path.
+    inline void seek_bound(predictive_iterator& itr, bool inclusive) const {
+        const std::string_view key = itr.m_key;
+        itr.is_beg = false;
+
+        std::uint64_t npos = 0;
+        for (std::uint64_t kpos = 0;; ++kpos) {
+            const char label = kpos != 0 ? key[kpos - 1] : '\0';
+
+            if (m_bcvec.is_leaf(npos)) {
+                std::string suffix;
+                m_tvec.decode(m_bcvec.link(npos), suffix);
+                const std::string_view rest = get_suffix(key, kpos);
+                if (inclusive ? rest <= suffix : rest < suffix) {
+                    itr.m_stack.push_back({label, kpos, npos});
+                }
+                return;
+            }
+
+            if (kpos == key.size()) {
+                if (inclusive) {
+                    itr.m_stack.push_back({label, kpos, npos});
+                } else {
+                    push_children(itr.m_stack, npos, kpos);  // without the term of the key itself
+                }
+                return;
+            }
+
+            push_children(itr.m_stack, npos, kpos, static_cast<std::uint8_t>(key[kpos]));
+
+            const std::uint64_t cpos = m_bcvec.base(npos) ^ m_table.get_code(key[kpos]);
+            if (m_bcvec.check(cpos) != npos) {
+                return;
+            }
+            npos = cpos;
+            itr.m_decoded.push_back(key[kpos]);
+        }
+    }
+
     inline bool next_predictive(predictive_iterator* itr) const {
         if (itr->is_end) {
             return false;
@@ -400,14 +1036,11 @@ class trie {
                 if (m_bcvec.is_leaf(npos)) {
                     itr->is_end = true;
                     const std::uint64_t tpos = m_bcvec.link(npos);
-                    if (tpos == 0) {
-                        return false;
-                    }
-                    if (!m_tvec.prefix_match(get_suffix(itr->m_key, kpos), tpos)) {
+                    if (!m_tvec.predictive_match(get_suffix(itr->m_key, kpos), tpos)) {
                         return false;
                     }
                     itr->m_id = npos_to_id(npos);
-                    m_tvec.decode(tpos, [&](char c) { itr->m_decoded.push_back(c); });
+                    m_tvec.decode(tpos, itr->m_decoded);
                     return true;
                 }
 
@@ -442,18 +1075,11 @@ class trie {
 
             if (m_bcvec.is_leaf(npos)) {
                 itr->m_id = npos_to_id(npos);
-                m_tvec.decode(m_bcvec.link(npos), [&](char c) { itr->m_decoded.push_back(c); });
+                m_tvec.decode(m_bcvec.link(npos), itr->m_decoded);
                 return true;
             }
 
-            const std::uint64_t base = m_bcvec.base(npos);
-
-            for (auto cit = m_table.rbegin(); cit != m_table.rend(); ++cit) {
-                const std::uint64_t cpos = base ^ m_table.get_code(*cit);
-                if (m_bcvec.check(cpos) == npos) {
-                    itr->m_stack.push_back({static_cast<char>(*cit), kpos + 1, cpos});
-                }
-            }
+            push_children(itr->m_stack, npos, kpos);
 
             if (m_terms[npos]) {
                 itr->m_id = npos_to_id(npos);
@@ -1,13 +1,18 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <iostream>
+#include <memory>
 #include <string_view>
 
 // #include "bc_vector.hpp"
 #include "code_table.hpp"
 #include "exception.hpp"
+#include "spill_vector.hpp"
 #include "tail_vector.hpp"
+#include "thread_tools.hpp"
+#include "unit_vector.hpp"
 
 namespace xcdat {
 
@@ -17,10 +22,7 @@ class trie_builder {
     friend class trie;
 
   public:
-    struct unit_type {
-        std::uint64_t base;
-        std::uint64_t check;
-    };
+    using unit_type = unit_vector::unit_type;
 
   private:
     static constexpr std::uint64_t taboo_npos = 1;
@@ -31,9 +33,12 @@ class trie_builder {
     const std::uint64_t m_l1_size;
 
     bool m_bin_mode = false;
+    std::uint32_t m_num_threads = 1;
+    std::uint64_t m_memory_budget = spill_vector<unit_type>::unlimited;  // in bytes
 
     code_table m_table;
-    std::vector<unit_type> m_units;
+    std::array<std::uint8_t, 256> m_codes;  // Copy of the code table, shared with sub-builders
+    unit_vector m_units;
     bit_vector::builder m_leaves;
     bit_vector::builder m_terms;
     bit_vector::builder m_useds;
@@ -42,14 +47,72 @@ class trie_builder {
     tail_vector::builder m_suffixes;
 
   public:
-    explicit trie_builder(const Strings& keys, std::uint32_t l1_bits, bool bin_mode)
-        : m_keys(keys), m_l1_bits(std::min(l1_bits, 8U)), m_l1_size(1ULL << m_l1_bits), m_bin_mode(bin_mode) {
+    // If num_threads > 1, the subtries are arranged in parallel and stitched into one double array.
+    // The result is not identical to the serial construction, but supports the same operations.
+    // The TAIL vector and the BC vector are also built on num_threads threads.
+    // The units and the suffixes are spilled to temporary files if their sizes exceed the halves of memory_budget.
+    explicit trie_builder(const Strings& keys, std::uint32_t l1_bits, bool bin_mode, std::uint32_t num_threads = 1,
+                          std::uint64_t memory_budget = spill_vector<unit_type>::unlimited)
+        : m_keys(keys), m_l1_bits(std::min(l1_bits, 8U)), m_l1_size(1ULL << m_l1_bits), m_bin_mode(bin_mode),
+          m_num_threads(std::max(num_threads, 1U)), m_memory_budget(memory_budget), m_units(memory_budget / 2),
+          m_suffixes(memory_budget / 2) {
         XCDAT_THROW_IF(m_keys.size() == 0, "The input dataset is empty.");
 
+        init_units(m_keys.size());
+
+        // Build the code table
+        m_table = code_table(keys);
+        m_bin_mode |= m_table.has_null();
+        for (std::uint32_t ch = 0; ch < 256; ++ch) {
+            m_codes[ch] = m_table.get_code(static_cast<char>(ch));
+        }
+
+        // Build the BC units
+        if (num_threads <= 1) {
+            arrange(0, m_keys.size(), 0, 0);
+        } else {
+            arrange_parallel(num_threads);
+        }
+
+        // Finish
+        finish();
+
+        // Build the TAIL vector
+        m_units.prepare(m_suffixes.max_tpos());
+        m_suffixes.complete(
+            m_bin_mode, [&](std::uint64_t npos, std::uint64_t tpos) { m_units.set_base(npos, tpos); }, num_threads);
+    }
+
+    virtual ~trie_builder() = default;
+
+    trie_builder(const trie_builder&) = delete;
+    trie_builder& operator=(const trie_builder&) = delete;
+
+    trie_builder(trie_builder&&) noexcept = default;
+    trie_builder& operator=(trie_builder&&) noexcept = default;
+
+  private:
+    // A subtrie arranged by a sub-builder in parallel construction.
+    struct subtrie_type {
+        std::uint64_t beg;
+        std::uint64_t end;
+        std::uint64_t kpos;
+        std::uint64_t npos;
+    };
+
+    // Make a sub-builder arranging subtries in its own units for parallel construction.
+    trie_builder(const trie_builder& parent, std::uint64_t num_keys)
+        : m_keys(parent.m_keys), m_l1_bits(parent.m_l1_bits), m_l1_size(parent.m_l1_size),
+          m_bin_mode(parent.m_bin_mode), m_memory_budget(parent.m_memory_budget / parent.m_num_threads),
+          m_codes(parent.m_codes), m_units(m_memory_budget / 2), m_suffixes(m_memory_budget / 2) {
+        init_units(num_keys);
+    }
+
+    void init_units(std::uint64_t num_keys) {
         // Reserve
         {
             std::uint64_t init_capa = 1;
-            while (init_capa < m_keys.size()) {
+            while (init_capa < num_keys) {
                 init_capa <<= 1;
             }
             m_units.reserve(init_capa);
@@ -62,13 +125,11 @@ class trie_builder {
 
         // Initialize an empty list.
         for (std::uint64_t npos = 0; npos < 256; ++npos) {
-            m_units.push_back(unit_type{npos + 1, npos - 1});
+            m_units.push_back((npos + 1) % 256, (npos + 255) % 256);
             m_leaves.push_back(false);
             m_terms.push_back(false);
             m_useds.push_back(false);
         }
-        m_units[255].base = 0;
-        m_units[0].check = 255;
 
         for (std::uint64_t npos = 0; npos < 256; npos += m_l1_size) {
             m_heads.push_back(npos);
@@ -76,40 +137,22 @@ class trie_builder {
 
         // Fix the root
         use_unit(0);
-        m_units[0].check = taboo_npos;
+        m_units.set_check(0, taboo_npos);
         m_useds.set_bit(taboo_npos, true);
         m_heads[taboo_npos >> m_l1_bits] = m_units[taboo_npos].base;
-
-        // Build the code table
-        m_table = code_table(keys);
-        m_bin_mode |= m_table.has_null();
-
-        // Build the BC units
-        arrange(0, m_keys.size(), 0, 0);
-
-        // Finish
-        finish();
-
-        // Build the TAIL vector
-        m_suffixes.complete(m_bin_mode, [&](std::uint64_t npos, std::uint64_t tpos) { m_units[npos].base = tpos; });
     }
 
-    virtual ~trie_builder() = default;
-
-    trie_builder(const trie_builder&) = delete;
-    trie_builder& operator=(const trie_builder&) = delete;
-
-    trie_builder(trie_builder&&) noexcept = default;
-    trie_builder& operator=(trie_builder&&) noexcept = default;
+    inline std::uint8_t get_code(std::uint8_t ch) const {
+        return m_codes[ch];
+    }
 
-  private:
     inline void use_unit(std::uint64_t npos) {
         m_useds.set_bit(npos);
 
         const auto next = m_units[npos].base;
         const auto prev = m_units[npos].check;
-        m_units[prev].base = next;
-        m_units[next].check = prev;
+        m_units.set_base(prev, next);
+        m_units.set_check(next, prev);
 
         const auto lpos = npos >> m_l1_bits;
         if (m_heads[lpos] == npos) {
@@ -125,8 +168,8 @@ class trie_builder {
             if (!m_useds[npos]) {
                 use_unit(npos);
                 m_useds.set_bit(npos, false);
-                m_units[npos].base = npos;
-                m_units[npos].check = npos;
+                m_units.set_base(npos, npos);
+                m_units.set_check(npos, npos);
             }
         }
 
@@ -140,7 +183,7 @@ class trie_builder {
         const auto new_size = old_size + 256;
 
         for (auto npos = old_size; npos < new_size; ++npos) {
-            m_units.push_back({npos + 1, npos - 1});
+            m_units.push_back(npos + 1, npos - 1);
             m_leaves.push_back(false);
             m_terms.push_back(false);
             m_useds.push_back(false);
@@ -148,10 +191,10 @@ class trie_builder {
 
         {
             const auto last_npos = m_units[taboo_npos].check;
-            m_units[old_size].check = last_npos;
-            m_units[last_npos].base = old_size;
-            m_units[new_size - 1].base = taboo_npos;
-            m_units[taboo_npos].check = new_size - 1;
+            m_units.set_check(old_size, last_npos);
+            m_units.set_base(last_npos, old_size);
+            m_units.set_base(new_size - 1, taboo_npos);
+            m_units.set_check(taboo_npos, new_size - 1);
         }
 
         for (auto npos = old_size; npos < new_size; npos += m_l1_size) {
@@ -172,21 +215,48 @@ class trie_builder {
     }
 
     void arrange(std::uint64_t beg, std::uint64_t end, std::uint64_t kpos, std::uint64_t npos) {
+        if (arrange_leaf(beg, end, kpos, npos)) {
+            return;
+        }
+
+        const auto base = arrange_edges(beg, end, kpos, npos);
+
+        // following the children
+        auto i = beg;
+        auto ch = static_cast<std::uint8_t>(m_keys[beg][kpos]);
+        for (auto j = beg + 1; j < end; ++j) {
+            const auto next_ch = static_cast<std::uint8_t>(m_keys[j][kpos]);
+            if (ch != next_ch) {
+                arrange(i, j, kpos + 1, base ^ get_code(ch));
+                ch = next_ch;
+                i = j;
+            }
+        }
+        arrange(i, end, kpos + 1, base ^ get_code(ch));
+    }
+
+    // Set the node of npos to a term and/or a leaf. Return true if the node is a leaf.
+    // If the node is a term but not a leaf, beg is incremented.
+    inline bool arrange_leaf(std::uint64_t& beg, std::uint64_t end, std::uint64_t kpos, std::uint64_t npos) {
         if (m_keys[beg].size() == kpos) {
             m_terms.set_bit(npos, true);
             if (++beg == end) {  // without link?
-                m_units[npos].base = 0;  // with an empty suffix
+                m_units.set_base(npos, 0);  // with an empty suffix
                 m_leaves.set_bit(npos, true);
-                return;
+                return true;
             }
         } else if (beg + 1 == end) {  // leaf?
             XCDAT_THROW_IF(m_keys[beg].size() <= kpos, "The input keys are not unique.");
             m_terms.set_bit(npos, true);
             m_leaves.set_bit(npos, true);
             m_suffixes.set_suffix({m_keys[beg].data() + kpos, m_keys[beg].size() - kpos}, npos);
-            return;
+            return true;
         }
+        return false;
+    }
 
+    // Define the children of the node of npos and return its base.
+    inline std::uint64_t arrange_edges(std::uint64_t beg, std::uint64_t end, std::uint64_t kpos, std::uint64_t npos) {
         // fetching edges
         {
             m_edges.clear();
@@ -208,57 +278,242 @@ class trie_builder {
         }
 
         // defining new edges
-        m_units[npos].base = base;
+        m_units.set_base(npos, base);
         for (const auto ch : m_edges) {
-            const auto child_id = base ^ m_table.get_code(ch);
+            const auto child_id = base ^ get_code(ch);
             use_unit(child_id);
-            m_units[child_id].check = npos;
+            m_units.set_check(child_id, npos);
+        }
+        return base;
+    }
+
+    // Arrange the top of the trie and collect the subtries with at most max_keys keys instead of arranging them.
+    void arrange_top(std::uint64_t beg, std::uint64_t end, std::uint64_t kpos, std::uint64_t npos,
+                     std::uint64_t max_keys, std::vector<subtrie_type>& subtries) {
+        if (npos != 0 && end - beg <= max_keys) {
+            if (end - beg == 1) {
+                arrange(beg, end, kpos, npos);
+            } else {
+                subtries.push_back({beg, end, kpos, npos});
+            }
+            return;
+        }
+
+        if (arrange_leaf(beg, end, kpos, npos)) {
+            return;
         }
 
+        const auto base = arrange_edges(beg, end, kpos, npos);
+
         // following the children
         auto i = beg;
         auto ch = static_cast<std::uint8_t>(m_keys[beg][kpos]);
         for (auto j = beg + 1; j < end; ++j) {
             const auto next_ch = static_cast<std::uint8_t>(m_keys[j][kpos]);
             if (ch != next_ch) {
-                arrange(i, j, kpos + 1, base ^ m_table.get_code(ch));
+                arrange_top(i, j, kpos + 1, base ^ get_code(ch), max_keys, subtries);
                 ch = next_ch;
                 i = j;
             }
         }
-        arrange(i, end, kpos + 1, base ^ m_table.get_code(ch));
+        arrange_top(i, end, kpos + 1, base ^ get_code(ch), max_keys, subtries);
     }
 
+    // Arrange the top of the trie on the main thread, and arrange the remaining subtries on num_threads threads.
+    // Each thread arranges its subtries in its own units, where the subtrie roots are placed at dummy positions.
+    // The units are then appended to the main units, where the positions are shifted by a multiple of 256
+    // (i.e., the offset does not change the lowest 8 bits, and so x ^ code + offset == (x + offset) ^ code).
+    void arrange_parallel(std::uint32_t num_threads) {
+        // The subtries are enough smaller than the work of each thread for load balancing.
+        const std::uint64_t max_keys = std::max<std::uint64_t>(m_keys.size() / (num_threads * 16), 1);
+
+        std::vector<subtrie_type> subtries;
+        arrange_top(0, m_keys.size(), 0, 0, max_keys, subtries);
+
+        // Close all the blocks of the top units so that no more free units remain.
+        finish();
+
+        // Partition the subtries into num_threads groups of consecutive ones with similar numbers of keys.
+        std::vector<std::uint64_t> bounds(num_threads + 1, subtries.size());
+        {
+            std::uint64_t total_keys = 0;
+            for (const auto& subtrie : subtries) {
+                total_keys += subtrie.end - subtrie.beg;
+            }
+            std::uint64_t num_keys = 0;
+            std::uint32_t t = 0;
+            bounds[0] = 0;
+            for (std::uint64_t i = 0; i < subtries.size(); i++) {
+                while (t < num_threads && num_keys >= total_keys * t / num_threads) {
+                    bounds[t++] = i;
+                }
+                num_keys += subtries[i].end - subtries[i].beg;
+            }
+        }
+
+        std::vector<std::unique_ptr<trie_builder>> builders(num_threads);
+        std::vector<std::vector<std::uint64_t>> roots(num_threads);  // The dummy positions of the subtrie roots
+
+        thread_tools::run(num_threads, [&](std::uint32_t t) {
+            std::uint64_t num_keys = 0;
+            for (std::uint64_t i = bounds[t]; i < bounds[t + 1]; i++) {
+                num_keys += subtries[i].end - subtries[i].beg;
+            }
+
+            builders[t].reset(new trie_builder(*this, num_keys));
+            trie_builder& b = *builders[t];
+
+            for (std::uint64_t i = bounds[t]; i < bounds[t + 1]; i++) {
+                const auto& subtrie = subtries[i];
+                const auto rpos = roots[t].empty() ? 0 : b.make_dummy_root();
+                roots[t].push_back(rpos);
+                b.arrange(subtrie.beg, subtrie.end, subtrie.kpos, rpos);
+            }
+            b.finish();
+        });
+
+        // Stitch the units
+        for (std::uint32_t t = 0; t < num_threads; t++) {
+            if (roots[t].empty()) {
+                continue;
+            }
+
+            const trie_builder& b = *builders[t];
+            const auto offset = static_cast<std::uint64_t>(m_units.size());
+            assert(offset % 256 == 0);
+
+            for (std::uint64_t npos = 0; npos < b.m_units.size(); ++npos) {
+                const auto& unit = b.m_units[npos];
+                // The bases of leaves are not positions but TAIL positions.
+                m_units.push_back(b.m_leaves[npos] ? unit.base : unit.base + offset, unit.check + offset);
+            }
+            m_leaves.append(b.m_leaves);
+            m_terms.append(b.m_terms);
+            m_useds.append(b.m_useds);
+            m_suffixes.append(b.m_suffixes, offset);
+
+            // The taboo unit is unused.
+            m_useds.set_bit(offset + taboo_npos, false);
+
+            for (std::uint64_t i = bounds[t]; i < bounds[t + 1]; i++) {
+                const auto npos = subtries[i].npos;
+                const auto rpos = roots[t][i - bounds[t]];
+                const auto base = b.m_units[rpos].base;
+
+                // Move the root from the dummy position.
+                m_units.set_base(npos, base + offset);
+                m_terms.set_bit(npos, b.m_terms[rpos]);
+                for (std::uint32_t cd = 0; cd < 256; ++cd) {
+                    const auto child_id = base ^ cd;
+                    if (child_id != taboo_npos && b.m_useds[child_id] && b.m_units[child_id].check == rpos) {
+                        m_units.set_check(child_id + offset, npos);
+                    }
+                }
+
+                // Release the dummy position.
+                m_units.set(rpos + offset, rpos + offset, rpos + offset);
+                m_terms.set_bit(rpos + offset, false);
+                m_useds.set_bit(rpos + offset, false);
+            }
+
+            builders[t].reset();
+        }
+    }
+
+    // Allocate a unit as a dummy root of a subtrie.
+    inline std::uint64_t make_dummy_root() {
+        if (m_units[taboo_npos].base == taboo_npos) {  // Full?
+            expand();
+        }
+        const auto npos = m_units[taboo_npos].base;
+        use_unit(npos);
+        m_units.set_check(npos, taboo_npos);
+        return npos;
+    }
+
+    // Find the base defining the children of m_edges on free units.
+    // The result is the same as searching the free list for the first unit i such that all the children of
+    // base = i ^ get_code(m_edges[0]) are free, but each 256-unit block is tested at once with its occupancy bitmap.
     inline std::uint64_t xcheck(std::uint64_t lpos) const {
         if (m_units[taboo_npos].base == taboo_npos) {  // Full?
-            return m_units.size() ^ m_table.get_code(m_edges[0]);
+            return m_units.size() ^ get_code(m_edges[0]);
         }
 
         // First, search in the same L1 block
-        for (auto i = m_heads[lpos]; i != taboo_npos && i >> m_l1_bits == lpos; i = m_units[i].base) {
-            const auto base = i ^ m_table.get_code(m_edges[0]);
-            if (is_target(base)) {
-                return base;  // base / block_size_ == lpos
+        if (m_heads[lpos] != taboo_npos) {
+            const auto beg_npos = lpos << m_l1_bits;
+            const auto i = find_in_block(beg_npos / 256, beg_npos % 256, beg_npos % 256 + m_l1_size);
+            if (i != UINT64_MAX) {
+                return i ^ get_code(m_edges[0]);  // base / block_size_ == lpos
             }
         }
 
-        // Second, search in the other blocks
-        for (auto i = m_units[taboo_npos].base; i != taboo_npos; i = m_units[i].base) {
-            const auto base = i ^ m_table.get_code(m_edges[0]);
-            if (is_target(base)) {
-                return base;  // base / block_size_ != lpos
+        // Second, search in the other blocks. Since the free list is sorted and the blocks before the head are
+        // closed, the blocks from the head to the end are searched in order.
+        const auto num_blocks = m_units.size() / 256;
+        for (auto bpos = m_units[taboo_npos].base / 256; bpos < num_blocks; ++bpos) {
+            const auto i = find_in_block(bpos, 0, 256);
+            if (i != UINT64_MAX) {
+                return i ^ get_code(m_edges[0]);  // base / block_size_ != lpos
             }
         }
-        return m_units.size() ^ m_table.get_code(m_edges[0]);
+        return m_units.size() ^ get_code(m_edges[0]);
     }
 
-    inline bool is_target(std::uint64_t base) const {
-        for (const auto ch : m_edges) {
-            if (m_useds[base ^ m_table.get_code(ch)]) {
-                return false;
+    // Find the smallest unit i in [beg,end) of the bpos-th block such that all the children of
+    // base = i ^ get_code(m_edges[0]) are free, or return UINT64_MAX.
+    inline std::uint64_t find_in_block(std::uint64_t bpos, std::uint64_t beg, std::uint64_t end) const {
+        // Since base ^ code stays in the same block, the children for all the 256 bases are tested in parallel
+        // by AND-ing the free bitmap permuted with each code.
+        std::array<std::uint64_t, 4> frees;
+        std::array<std::uint64_t, 4> cands;
+        for (std::uint64_t j = 0; j < 4; ++j) {
+            frees[j] = ~m_useds.get_word(bpos * 4 + j);
+            const auto wbeg = std::clamp<std::uint64_t>(beg, j * 64, j * 64 + 64) - j * 64;
+            const auto wend = std::clamp<std::uint64_t>(end, j * 64, j * 64 + 64) - j * 64;
+            const auto range = wend - wbeg == 64 ? UINT64_MAX : ((1ULL << (wend - wbeg)) - 1) << wbeg;
+            cands[j] = frees[j] & range;
+        }
+
+        const auto code = get_code(m_edges[0]);
+        for (std::uint64_t k = 1; k < m_edges.size(); ++k) {
+            if ((cands[0] | cands[1] | cands[2] | cands[3]) == 0) {
+                return UINT64_MAX;
+            }
+            const auto perm = xor_permute(frees, code ^ get_code(m_edges[k]));
+            for (std::uint64_t j = 0; j < 4; ++j) {
+                cands[j] &= perm[j];
+            }
+        }
+
+        for (std::uint64_t j = 0; j < 4; ++j) {
+            if (cands[j] != 0) {
+                return bpos * 256 + j * 64 + bit_tools::lsb(cands[j]);
+            }
+        }
+        return UINT64_MAX;
+    }
+
+    // Return the 256-bit bitmap whose i-th bit is the (i ^ x)-th bit of the given bitmap.
+    static inline std::array<std::uint64_t, 4> xor_permute(const std::array<std::uint64_t, 4>& bits, std::uint64_t x) {
+        static constexpr std::uint64_t masks[6] = {
+            0x5555555555555555ULL, 0x3333333333333333ULL, 0x0F0F0F0F0F0F0F0FULL,
+            0x00FF00FF00FF00FFULL, 0x0000FFFF0000FFFFULL, 0x00000000FFFFFFFFULL,
+        };
+
+        std::array<std::uint64_t, 4> perm;
+        for (std::uint64_t j = 0; j < 4; ++j) {
+            perm[j] = bits[j ^ (x >> 6)];
+        }
+        for (std::uint64_t k = 0; k < 6; ++k) {
+            if ((x >> k) & 1) {
+                const std::uint64_t s = 1ULL << k;
+                for (std::uint64_t j = 0; j < 4; ++j) {
+                    perm[j] = ((perm[j] >> s) & masks[k]) | ((perm[j] & masks[k]) << s);
+                }
             }
         }
-        return true;
+        return perm;
     }
 };
 
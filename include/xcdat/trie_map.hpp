@@ -0,0 +1,110 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "trie.hpp"
+#include "value_codec.hpp"
+
+namespace xcdat {
+
+//! A trie dictionary that associates a value with each keyword.
+//! The values are stored in ID order next to the trie, so that they are saved, loaded, and memory-mapped
+//! together with the keywords. 'ValueCodec' is the storage of the values such as xcdat::int_value_codec
+//! (for fixed-width integers) or xcdat::blob_value_codec (for variable-length byte strings).
+template <class BcVector, class ValueCodec>
+class trie_map {
+  public:
+    using trie_type = trie<BcVector>;
+    using value_codec_type = ValueCodec;
+    using value_type = typename value_codec_type::value_type;
+
+    //! The type identifier, combining those of the trie and the value codec.
+    static constexpr std::uint32_t type_id = trie_type::type_id | (value_codec_type::type_id << 16);
+
+  private:
+    trie_type m_trie;
+    value_codec_type m_values;
+
+  public:
+    //! Default constructor
+    trie_map() = default;
+
+    //! Default destructor
+    virtual ~trie_map() = default;
+
+    //! Copy constructor (deleted)
+    trie_map(const trie_map&) = delete;
+
+    //! Copy constructor (deleted)
+    trie_map& operator=(const trie_map&) = delete;
+
+    //! Move constructor
+    trie_map(trie_map&&) noexcept = default;
+
+    //! Move constructor
+    trie_map& operator=(trie_map&&) noexcept = default;
+
+    //! Build the dictionary from the input keywords, which are lexicographically sorted and unique,
+    //! where 'values[i]' is associated with 'keys[i]'. The other arguments are the same as those of trie.
+    template <class Strings, class Values>
+    trie_map(const Strings& keys, const Values& values, bool bin_mode = false, std::uint32_t num_threads = 1,
+             std::uint64_t memory_budget = UINT64_MAX)
+        : m_trie(keys, bin_mode, num_threads, memory_budget) {
+        XCDAT_THROW_IF(keys.size() != values.size(), "The number of values is different from that of keywords.");
+
+        std::vector<std::uint64_t> ids(keys.size());
+        thread_tools::run_ranges(num_threads, keys.size(), [&](std::uint64_t beg, std::uint64_t end) {
+            for (std::uint64_t i = beg; i < end; ++i) {
+                const auto& key = keys[i];
+                ids[i] = m_trie.lookup(std::string_view(key.data(), key.size())).value();
+            }
+        });
+        m_values = value_codec_type(values, ids);
+    }
+
+    //! Get the trie of the keywords.
+    inline const trie_type& get_trie() const {
+        return m_trie;
+    }
+
+    //! Get the number of stored keywords.
+    inline std::uint64_t num_keys() const {
+        return m_trie.num_keys();
+    }
+
+    //! Lookup the ID of the keyword.
+    inline std::optional<std::uint64_t> lookup(std::string_view key) const {
+        return m_trie.lookup(key);
+    }
+
+    //! Decode the keyword associated with the ID.
+    inline std::string decode(std::uint64_t id) const {
+        return m_trie.decode(id);
+    }
+
+    //! Get the value associated with the ID.
+    inline value_type value(std::uint64_t id) const {
+        return m_values.get(id);
+    }
+
+    //! Get the value associated with the keyword, or std::nullopt if the keyword is not stored.
+    inline std::optional<value_type> get(std::string_view key) const {
+        const auto id = m_trie.lookup(key);
+        if (!id.has_value()) {
+            return std::nullopt;
+        }
+        return m_values.get(id.value());
+    }
+
+    //! Visit the members (commonly used for I/O).
+    template <class Visitor>
+    void visit(Visitor& visitor) {
+        visitor.visit(m_trie);
+        visitor.visit(m_values);
+    }
+};
+
+}  // namespace xcdat
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "trie.hpp"
+
+namespace xcdat {
+
+//! The result of xcdat::merge: the merged trie and the mappings from the old IDs to the new ones.
+template <class Trie>
+struct merge_result {
+    Trie trie;
+    std::vector<std::uint64_t> a_ids;  // ID in the 1st input -> ID in the merged trie
+    std::vector<std::uint64_t> b_ids;  // ID in the 2nd input -> ID in the merged trie
+};
+
+//! Merge the keywords of two tries into a new trie, where the duplicate keywords are stored once.
+//! Both the tries are enumerated in the lexicographic order, so the merged keywords are passed to the builder
+//! without sorting. The optional data such as label links, scores, and sorted IDs are not inherited.
+//! The arguments after the tries are the same as those of trie.
+template <class BcVector>
+[[maybe_unused]] merge_result<trie<BcVector>> merge(const trie<BcVector>& a, const trie<BcVector>& b,
+                                                    bool bin_mode = false, std::uint32_t num_threads = 1,
+                                                    std::uint64_t memory_budget = UINT64_MAX) {
+    merge_result<trie<BcVector>> result;
+    result.a_ids.resize(a.num_keys());
+    result.b_ids.resize(b.num_keys());
+
+    // The merged keywords are concatenated, and the old IDs temporarily keep their positions in the order.
+    std::vector<char> chars;
+    std::vector<std::uint64_t> begs = {0};
+
+    auto append = [&](std::string_view key) {
+        chars.insert(chars.end(), key.begin(), key.end());
+        begs.push_back(chars.size());
+    };
+
+    auto a_itr = a.make_enumerative_iterator();
+    auto b_itr = b.make_enumerative_iterator();
+    bool a_has = a.num_keys() != 0 && a_itr.next();  // the empty trie can be default-constructed
+    bool b_has = b.num_keys() != 0 && b_itr.next();
+
+    while (a_has || b_has) {
+        const std::uint64_t i = begs.size() - 1;
+        if (!b_has || (a_has && a_itr.decoded_view() < b_itr.decoded_view())) {
+            append(a_itr.decoded_view());
+            result.a_ids[a_itr.id()] = i;
+            a_has = a_itr.next();
+        } else if (!a_has || b_itr.decoded_view() < a_itr.decoded_view()) {
+            append(b_itr.decoded_view());
+            result.b_ids[b_itr.id()] = i;
+            b_has = b_itr.next();
+        } else {
+            append(a_itr.decoded_view());
+            result.a_ids[a_itr.id()] = i;
+            result.b_ids[b_itr.id()] = i;
+            a_has = a_itr.next();
+            b_has = b_itr.next();
+        }
+    }
+
+    std::vector<std::string_view> keys(begs.size() - 1);
+    for (std::uint64_t i = 0; i < keys.size(); i++) {
+        keys[i] = std::string_view(chars.data() + begs[i], begs[i + 1] - begs[i]);
+    }
+    result.trie = trie<BcVector>(keys, bin_mode, num_threads, memory_budget);
+
+    // The merged trie is also enumerated in the lexicographic order, so the i-th keyword gives the new ID.
+    std::vector<std::uint64_t> new_ids(keys.size());
+    std::uint64_t i = 0;
+    result.trie.enumerate([&](std::uint64_t id, std::string_view) { new_ids[i++] = id; });
+
+    for (auto& id : result.a_ids) {
+        id = new_ids[id];
+    }
+    for (auto& id : result.b_ids) {
+        id = new_ids[id];
+    }
+    return result;
+}
+
+}  // namespace xcdat
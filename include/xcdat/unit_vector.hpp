@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "spill_vector.hpp"
+
+namespace xcdat {
+
+// The vector of BASE/CHECK units for construction. The units are stored in 32-bit integers while all the values
+// fit, and are widened to 64-bit integers when a larger value is set. This halves the memory of the units for
+// most datasets, i.e., with less than 2^32 units and TAIL positions.
+class unit_vector {
+  public:
+    struct unit_type {
+        std::uint64_t base;
+        std::uint64_t check;
+    };
+
+  private:
+    struct compact_unit_type {
+        std::uint32_t base;
+        std::uint32_t check;
+    };
+
+    static constexpr std::uint64_t compact_max = UINT32_MAX;
+
+    bool m_wide = false;
+    spill_vector<compact_unit_type> m_compact_units;
+    spill_vector<unit_type> m_units;
+
+  public:
+    unit_vector() = default;
+    virtual ~unit_vector() = default;
+
+    unit_vector(const unit_vector&) = delete;
+    unit_vector& operator=(const unit_vector&) = delete;
+
+    unit_vector(unit_vector&&) noexcept = default;
+    unit_vector& operator=(unit_vector&&) noexcept = default;
+
+    // The units are spilled to a temporary file if their size exceeds memory_budget bytes.
+    explicit unit_vector(std::uint64_t memory_budget) : m_compact_units(memory_budget), m_units(memory_budget) {}
+
+    inline unit_type operator[](std::uint64_t i) const {
+        if (m_wide) {
+            return m_units[i];
+        }
+        const compact_unit_type& unit = m_compact_units[i];
+        return {unit.base, unit.check};
+    }
+
+    inline void set(std::uint64_t i, std::uint64_t base, std::uint64_t check) {
+        if (!m_wide) {
+            if (base <= compact_max && check <= compact_max) {
+                m_compact_units[i] = {static_cast<std::uint32_t>(base), static_cast<std::uint32_t>(check)};
+                return;
+            }
+            widen();
+        }
+        m_units[i] = {base, check};
+    }
+
+    inline void set_base(std::uint64_t i, std::uint64_t base) {
+        if (!m_wide) {
+            if (base <= compact_max) {
+                m_compact_units[i].base = static_cast<std::uint32_t>(base);
+                return;
+            }
+            widen();
+        }
+        m_units[i].base = base;
+    }
+
+    inline void set_check(std::uint64_t i, std::uint64_t check) {
+        if (!m_wide) {
+            if (check <= compact_max) {
+                m_compact_units[i].check = static_cast<std::uint32_t>(check);
+                return;
+            }
+            widen();
+        }
+        m_units[i].check = check;
+    }
+
+    inline void push_back(std::uint64_t base, std::uint64_t check) {
+        if (!m_wide) {
+            if (base <= compact_max && check <= compact_max) {
+                m_compact_units.push_back({static_cast<std::uint32_t>(base), static_cast<std::uint32_t>(check)});
+                return;
+            }
+            widen();
+        }
+        m_units.push_back({base, check});
+    }
+
+    inline void reserve(std::uint64_t capa) {
+        if (m_wide) {
+            m_units.reserve(capa);
+        } else {
+            m_compact_units.reserve(capa);
+        }
+    }
+
+    // Widen the units in advance if values greater than max_value can be set.
+    // This should be called before setting values on multiple threads, since widening is not thread-safe.
+    void prepare(std::uint64_t max_value) {
+        if (!m_wide && max_value > compact_max) {
+            widen();
+        }
+    }
+
+    inline std::uint64_t size() const {
+        return m_wide ? m_units.size() : m_compact_units.size();
+    }
+
+    inline bool is_wide() const {
+        return m_wide;
+    }
+
+    inline std::uint64_t memory_in_bytes() const {
+        return m_wide ? m_units.capacity() * sizeof(unit_type)
+                      : m_compact_units.capacity() * sizeof(compact_unit_type);
+    }
+
+  private:
+    void widen() {
+        m_units.reserve(std::max<std::uint64_t>(m_compact_units.capacity(), 1));
+        for (std::uint64_t i = 0; i < m_compact_units.size(); ++i) {
+            m_units.push_back({m_compact_units[i].base, m_compact_units[i].check});
+        }
+        m_compact_units.clear();
+        m_wide = true;
+    }
+};
+
+}  // namespace xcdat
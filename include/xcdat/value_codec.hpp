@@ -0,0 +1,116 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "compact_vector.hpp"
+#include "immutable_vector.hpp"
+
+namespace xcdat {
+
+// Fixed-width integer values packed into the bits needed for the maximum value.
+class int_value_codec {
+  public:
+    using value_type = std::uint64_t;
+
+    static constexpr std::uint32_t type_id = 1;
+
+  private:
+    compact_vector m_values;
+
+  public:
+    int_value_codec() = default;
+    virtual ~int_value_codec() = default;
+
+    int_value_codec(const int_value_codec&) = delete;
+    int_value_codec& operator=(const int_value_codec&) = delete;
+
+    int_value_codec(int_value_codec&&) noexcept = default;
+    int_value_codec& operator=(int_value_codec&&) noexcept = default;
+
+    // Store values[i] as the value of ID ids[i].
+    template <class Values>
+    explicit int_value_codec(const Values& values, const std::vector<std::uint64_t>& ids) {
+        std::vector<std::uint64_t> id_values(values.size());
+        for (std::uint64_t i = 0; i < values.size(); ++i) {
+            id_values[ids[i]] = values[i];
+        }
+        if (!id_values.empty()) {
+            m_values = compact_vector(id_values);
+        }
+    }
+
+    inline value_type get(std::uint64_t id) const {
+        return m_values[id];
+    }
+
+    inline std::uint64_t size() const {
+        return m_values.size();
+    }
+
+    template <class Visitor>
+    void visit(Visitor& visitor) {
+        visitor.visit(m_values);
+    }
+};
+
+// Variable-length byte strings concatenated in ID order, with the offsets packed into compact_vector.
+class blob_value_codec {
+  public:
+    using value_type = std::string_view;
+
+    static constexpr std::uint32_t type_id = 2;
+
+  private:
+    compact_vector m_offsets;  // of size + 1 elements
+    immutable_vector<char> m_bytes;
+
+  public:
+    blob_value_codec() = default;
+    virtual ~blob_value_codec() = default;
+
+    blob_value_codec(const blob_value_codec&) = delete;
+    blob_value_codec& operator=(const blob_value_codec&) = delete;
+
+    blob_value_codec(blob_value_codec&&) noexcept = default;
+    blob_value_codec& operator=(blob_value_codec&&) noexcept = default;
+
+    // Store values[i] as the value of ID ids[i].
+    // The type 'Values::value_type' should provide data() and size() of one-byte characters such as std::string.
+    template <class Values>
+    explicit blob_value_codec(const Values& values, const std::vector<std::uint64_t>& ids) {
+        std::vector<std::uint64_t> offsets(values.size() + 1);
+        for (std::uint64_t i = 0; i < values.size(); ++i) {
+            offsets[ids[i] + 1] = values[i].size();
+        }
+        for (std::uint64_t i = 0; i < values.size(); ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+
+        std::vector<char> bytes(offsets.back());
+        for (std::uint64_t i = 0; i < values.size(); ++i) {
+            const auto& value = values[i];
+            std::copy_n(value.data(), value.size(), bytes.data() + offsets[ids[i]]);
+        }
+
+        m_offsets = compact_vector(offsets);
+        m_bytes.build(bytes);
+    }
+
+    inline value_type get(std::uint64_t id) const {
+        const std::uint64_t beg = m_offsets[id];
+        return std::string_view(m_bytes.data() + beg, m_offsets[id + 1] - beg);
+    }
+
+    inline std::uint64_t size() const {
+        return m_offsets.size() != 0 ? m_offsets.size() - 1 : 0;
+    }
+
+    template <class Visitor>
+    void visit(Visitor& visitor) {
+        visitor.visit(m_offsets);
+        visitor.visit(m_bytes);
+    }
+};
+
+}  // namespace xcdat
@@ -19,11 +19,14 @@ keyset.append('iPhone')
 keyset.append('iPhone_SE')
 keyset.complete()
 
-# You can choose a trie type from the four types.
+# You can choose a trie type from the seven types.
 Trie = xcdat.Trie8
 # Trie = xcdat.Trie16
 # Trie = xcdat.Trie7
 # Trie = xcdat.Trie15
+# Trie = xcdat.Trie7i
+# Trie = xcdat.Trie32
+# Trie = xcdat.Trie64
 
 # Build the trie dictionary
 trie = Trie(keyset)
@@ -134,4 +134,16 @@ PYBIND11_MODULE(xcdat, m) {
     define_Trie<xcdat::trie_15_type>(m, "15");
     define_PrefixIterator<xcdat::trie_15_type>(m, "15");
     define_PredictiveIterator<xcdat::trie_15_type>(m, "15");
+
+    define_Trie<xcdat::trie_7i_type>(m, "7i");
+    define_PrefixIterator<xcdat::trie_7i_type>(m, "7i");
+    define_PredictiveIterator<xcdat::trie_7i_type>(m, "7i");
+
+    define_Trie<xcdat::trie_32_type>(m, "32");
+    define_PrefixIterator<xcdat::trie_32_type>(m, "32");
+    define_PredictiveIterator<xcdat::trie_32_type>(m, "32");
+
+    define_Trie<xcdat::trie_64_type>(m, "64");
+    define_PrefixIterator<xcdat::trie_64_type>(m, "64");
+    define_PredictiveIterator<xcdat::trie_64_type>(m, "64");
 }
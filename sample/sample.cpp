@@ -14,11 +14,14 @@ int main() {
     std::sort(keys.begin(), keys.end());
     keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
 
-    // The trie dictionary type from the four types
+    // The trie dictionary type from the seven types
     using trie_type = xcdat::trie_8_type;
     // using trie_type = xcdat::trie_16_type;
     // using trie_type = xcdat::trie_7_type;
     // using trie_type = xcdat::trie_15_type;
+    // using trie_type = xcdat::trie_7i_type;
+    // using trie_type = xcdat::trie_32_type;
+    // using trie_type = xcdat::trie_64_type;
 
     // The dictionary filename
     const char* tmp_filename = "dic.bin";
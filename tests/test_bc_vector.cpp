@@ -4,10 +4,15 @@
 #include <random>
 
 #include "doctest/doctest.h"
+#include "mm_file/mm_file.hpp"
 #include "test_common.hpp"
+#include "xcdat.hpp"
 #include "xcdat/bc_vector_15.hpp"
 #include "xcdat/bc_vector_16.hpp"
+#include "xcdat/bc_vector_32.hpp"
+#include "xcdat/bc_vector_64.hpp"
 #include "xcdat/bc_vector_7.hpp"
+#include "xcdat/bc_vector_7i.hpp"
 #include "xcdat/bc_vector_8.hpp"
 
 #ifdef BC_VECTOR_7
@@ -22,6 +27,24 @@ using bc_vector_type = xcdat::bc_vector_15;
 #elif BC_VECTOR_16
 using bc_vector_type = xcdat::bc_vector_16;
 #define BC_NAME "xcdat::bc_vector_16"
+#elif BC_VECTOR_7i
+using bc_vector_type = xcdat::bc_vector_7i;
+#define BC_NAME "xcdat::bc_vector_7i"
+#elif BC_VECTOR_32
+using bc_vector_type = xcdat::bc_vector_32;
+#define BC_NAME "xcdat::bc_vector_32"
+#define BC_MAX_VALUE INT32_MAX  // for the leaf flag in CHECK
+#define BC_MAX_NAME "INT32_MAX"
+#elif BC_VECTOR_64
+using bc_vector_type = xcdat::bc_vector_64;
+#define BC_NAME "xcdat::bc_vector_64"
+#define BC_MAX_VALUE INT64_MAX  // for the leaf flag in CHECK
+#define BC_MAX_NAME "INT64_MAX"
+#endif
+
+#ifndef BC_MAX_VALUE
+#define BC_MAX_VALUE UINT64_MAX
+#define BC_MAX_NAME "UINT64_MAX"
 #endif
 
 struct bc_unit {
@@ -53,9 +76,8 @@ std::uint64_t get_num_ones(const std::vector<bool>& bits) {
     return std::accumulate(bits.begin(), bits.end(), 0ULL);
 }
 
-void test_bc_vector(const std::vector<bc_unit>& bc_units, const std::vector<bool>& leaves) {
-    bc_vector_type bc(bc_units, to_bit_vector_builder(leaves));
-
+void test_bc_vector(const bc_vector_type& bc, const std::vector<bc_unit>& bc_units,
+                    const std::vector<bool>& leaves) {
     REQUIRE_EQ(bc.num_units(), bc_units.size());
     REQUIRE_EQ(bc.num_leaves(), get_num_ones(leaves));
 
@@ -70,6 +92,12 @@ void test_bc_vector(const std::vector<bc_unit>& bc_units, const std::vector<bool
     }
 }
 
+void test_bc_vector(const std::vector<bc_unit>& bc_units, const std::vector<bool>& leaves,
+                    std::uint32_t num_threads = 1) {
+    bc_vector_type bc(bc_units, to_bit_vector_builder(leaves), num_threads);
+    test_bc_vector(bc, bc_units, leaves);
+}
+
 TEST_CASE("Test " BC_NAME " 10K in [0,10K)") {
     const std::uint64_t size = 10000;
     auto bc_units = make_random_units(size, size - 1);
@@ -77,9 +105,68 @@ TEST_CASE("Test " BC_NAME " 10K in [0,10K)") {
     test_bc_vector(bc_units, leaves);
 }
 
-TEST_CASE("Test " BC_NAME " 10K in [0,UINT64_MAX)") {
+TEST_CASE("Test " BC_NAME " 10K in [0," BC_MAX_NAME ")") {
     const std::uint64_t size = 10000;
-    auto bc_units = make_random_units(size, UINT64_MAX);
+    auto bc_units = make_random_units(size, BC_MAX_VALUE);
     auto leaves = xcdat::test::make_random_bits(size, 0.2);
     test_bc_vector(bc_units, leaves);
 }
+
+TEST_CASE("Test " BC_NAME " 10K in [0,10K), 4 threads") {
+    const std::uint64_t size = 10000;
+    auto bc_units = make_random_units(size, size - 1);
+    auto leaves = xcdat::test::make_random_bits(size, 0.2);
+    test_bc_vector(bc_units, leaves, 4);
+}
+
+TEST_CASE("Test " BC_NAME " 100K in [0," BC_MAX_NAME "), 4 threads") {
+    const std::uint64_t size = 100000;
+    auto bc_units = make_random_units(size, BC_MAX_VALUE);
+    auto leaves = xcdat::test::make_random_bits(size, 0.2);
+    test_bc_vector(bc_units, leaves, 4);
+}
+
+#if defined(BC_VECTOR_32) || defined(BC_VECTOR_64)
+TEST_CASE("Test " BC_NAME " 10K in [0,UINT64_MAX) (overflow)") {
+    const std::uint64_t size = 10000;
+    auto bc_units = make_random_units(size, UINT64_MAX);
+    auto leaves = xcdat::test::make_random_bits(size, 0.2);
+    REQUIRE_THROWS_AS(bc_vector_type(bc_units, to_bit_vector_builder(leaves)), xcdat::exception);
+}
+#endif
+
+#ifdef BC_VECTOR_7i
+TEST_CASE("Test " BC_NAME " 10K in [0,10K) (mmap, aligned lines)") {
+    const std::uint64_t size = 10000;
+    auto bc_units = make_random_units(size, size - 1);
+    auto leaves = xcdat::test::make_random_bits(size, 0.2);
+
+    const char* tmp_filepath = "tmp.bc_vector_7i";
+    const bc_vector_type bc(bc_units, to_bit_vector_builder(leaves));
+    REQUIRE_EQ(xcdat::memory_in_bytes(bc), xcdat::save(bc, tmp_filepath));
+
+    {
+        const auto loaded = xcdat::load<bc_vector_type>(tmp_filepath);
+        REQUIRE_EQ(reinterpret_cast<std::uintptr_t>(loaded.lines()) % 64, 0);
+        test_bc_vector(loaded, bc_units, leaves);
+    }
+    {
+        // The lines are padded to start at a 64-byte boundary in the file, which is mapped on a page boundary.
+        mm::file_source<char> fin(tmp_filepath, mm::advice::sequential);
+        const auto mapped = xcdat::mmap<bc_vector_type>(fin.data());
+        REQUIRE_EQ(reinterpret_cast<std::uintptr_t>(mapped.lines()) % 64, 0);
+        REQUIRE(fin.data() <= reinterpret_cast<const char*>(mapped.lines()));
+        REQUIRE(reinterpret_cast<const char*>(mapped.lines()) < fin.data() + fin.size());
+        test_bc_vector(mapped, bc_units, leaves);
+
+        // The lines are copied if the mapped address is misaligned.
+        std::vector<char> buffer(fin.size() + 1);
+        std::copy(fin.data(), fin.data() + fin.size(), buffer.begin() + 1);
+        const auto copied = xcdat::mmap<bc_vector_type>(buffer.data() + 1);
+        REQUIRE_EQ(reinterpret_cast<std::uintptr_t>(copied.lines()) % 64, 0);
+        test_bc_vector(copied, bc_units, leaves);
+    }
+
+    std::remove(tmp_filepath);
+}
+#endif
@@ -97,6 +97,27 @@ TEST_CASE("Test bit_vector::builder with push_back") {
     }
 }
 
+TEST_CASE("Test bit_vector::builder with append") {
+    const auto bits = xcdat::test::make_random_bits(10000);
+
+    for (const std::uint64_t mid : {0, 64, 1000, 6400, 9999}) {
+        xcdat::bit_vector::builder bvb1, bvb2;
+        for (std::uint64_t i = 0; i < mid; i++) {
+            bvb1.push_back(bits[i]);
+        }
+        for (std::uint64_t i = mid; i < bits.size(); i++) {
+            bvb2.push_back(bits[i]);
+        }
+        bvb1.append(bvb2);
+
+        REQUIRE_EQ(bvb1.size(), bits.size());
+
+        for (std::uint64_t i = 0; i < bits.size(); i++) {
+            REQUIRE_EQ(bvb1[i], bits[i]);
+        }
+    }
+}
+
 TEST_CASE("Test rank/select operations") {
     const auto bits = xcdat::test::make_random_bits(10000);
     test_rank_select(bits);
@@ -0,0 +1,145 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "doctest/doctest.h"
+#include "test_common.hpp"
+#include "xcdat.hpp"
+
+using delta_trie_type = xcdat::delta_trie<xcdat::bc_vector_8>;
+
+// Check that keys[i] is associated with ID i.
+void test_delta_trie(const delta_trie_type& trie, const std::vector<std::string>& keys,
+                     const std::vector<std::string>& others) {
+    REQUIRE_EQ(trie.num_keys(), keys.size());
+    for (std::uint64_t i = 0; i < keys.size(); i++) {
+        REQUIRE_EQ(trie.lookup(keys[i]), i);
+        REQUIRE_EQ(trie.decode(i), keys[i]);
+    }
+    for (auto& other : others) {
+        REQUIRE_FALSE(trie.lookup(other).has_value());
+    }
+}
+
+TEST_CASE("Test xcdat::delta_trie (tiny)") {
+    std::vector<std::string> keys = {"AirPods", "AirTag", "Mac", "MacBook", "iMac", "iPad", "iPhone"};
+
+    delta_trie_type trie(keys, 100);
+    for (std::uint64_t i = 0; i < keys.size(); i++) {
+        keys[i] = trie.decode(i);  // in order of IDs
+    }
+
+    for (const std::string key : {"MacBook_Air", "", "iPhone_SE", "Mac_Mini"}) {
+        REQUIRE_EQ(trie.insert(key), keys.size());
+        keys.push_back(key);
+    }
+    REQUIRE_EQ(trie.insert("Mac"), trie.lookup("Mac"));
+    REQUIRE_EQ(trie.insert("iPhone_SE"), keys.size() - 2);
+    REQUIRE_EQ(trie.num_delta_keys(), 4);
+    test_delta_trie(trie, keys, {"Google_Pixel", "iPad_mini", "MacBook_Pro"});
+
+    trie.merge();
+    REQUIRE_EQ(trie.num_static_keys(), keys.size());
+    REQUIRE_EQ(trie.num_delta_keys(), 0);
+    test_delta_trie(trie, keys, {"Google_Pixel", "iPad_mini", "MacBook_Pro"});
+
+    REQUIRE_EQ(trie.insert("MacBook_Pro"), keys.size());
+    keys.push_back("MacBook_Pro");
+    test_delta_trie(trie, keys, {"Google_Pixel", "iPad_mini"});
+}
+
+TEST_CASE("Test xcdat::delta_trie (random 10K, 0x00--0xFF, background merges)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, INT8_MIN, INT8_MAX));
+    auto others = xcdat::test::extract_keys(keys);
+    auto inserted = xcdat::test::extract_keys(keys, 0.5, 29);
+    std::shuffle(inserted.begin(), inserted.end(), std::mt19937_64(31));
+
+    delta_trie_type trie(keys, 500, 2);
+    for (std::uint64_t i = 0; i < keys.size(); i++) {
+        keys[i] = trie.decode(i);
+    }
+
+    // Readers check the visible keywords while the delta is inserted and merged.
+    std::atomic<std::uint64_t> num_visible = keys.size();
+    std::atomic<bool> is_done = false;
+    std::vector<std::string> all_keys = keys;
+    all_keys.insert(all_keys.end(), inserted.begin(), inserted.end());
+
+    std::vector<std::thread> readers;
+    std::vector<std::uint64_t> num_errors(2);
+    for (std::uint64_t r = 0; r < num_errors.size(); r++) {
+        readers.emplace_back([&, r]() {
+            for (std::uint64_t i = r; !is_done.load(); i = (i + 7919) % all_keys.size()) {
+                const std::uint64_t n = num_visible.load();
+                const std::uint64_t id = i % n;
+                if (trie.lookup(all_keys[id]) != id || trie.decode(id) != all_keys[id]) {
+                    num_errors[r] += 1;
+                }
+            }
+        });
+    }
+
+    for (auto& key : inserted) {
+        REQUIRE_EQ(trie.insert(key), num_visible.load());
+        num_visible.fetch_add(1);
+    }
+    trie.wait_merge();
+    is_done.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    REQUIRE_EQ(num_errors, std::vector<std::uint64_t>(num_errors.size(), 0));
+
+    REQUIRE_LT(trie.num_delta_keys(), inserted.size());  // some merges have been done
+    test_delta_trie(trie, all_keys, others);
+
+    trie.merge();
+    REQUIRE_EQ(trie.num_delta_keys(), 0);
+    test_delta_trie(trie, all_keys, others);
+}
+
+TEST_CASE("Test xcdat::delta_trie (runs of the delta)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, 'A', 'Z'));
+    auto inserted = xcdat::test::extract_keys(keys, 0.5, 37);
+    std::shuffle(inserted.begin(), inserted.end(), std::mt19937_64(41));
+
+    delta_trie_type trie(keys, UINT64_MAX);  // never merged
+
+    // After n inserts, the runs are the powers of two in the binary representation of n, in decreasing order.
+    // So there are at most floor(log2(n))+1 runs, and a keyword is copied only when its run is carried into
+    // a run twice as large, which happens at most floor(log2(n)) times.
+    std::uint64_t num_copied = 0;
+    std::vector<std::uint64_t> prev_sizes;
+    for (std::uint64_t n = 1; n <= inserted.size(); n++) {
+        REQUIRE_EQ(trie.insert(inserted[n - 1]), keys.size() + n - 1);
+
+        std::vector<std::uint64_t> expected;
+        for (std::uint64_t bit = 1ULL << 63; bit != 0; bit >>= 1) {
+            if (n & bit) {
+                expected.push_back(bit);
+            }
+        }
+        const auto sizes = trie.delta_run_sizes();
+        REQUIRE_EQ(sizes, expected);
+        REQUIRE_LE(sizes.size(), xcdat::bit_tools::msb(n) + 1);
+
+        // The runs that disappeared were merged one by one into the new run from the smallest.
+        std::uint64_t merged = 1;
+        for (std::uint64_t i = prev_sizes.size(); i-- > sizes.size() - 1;) {
+            merged += prev_sizes[i];
+            num_copied += merged;
+        }
+        prev_sizes = sizes;
+    }
+    REQUIRE_LE(num_copied, inserted.size() * xcdat::bit_tools::msb(inserted.size()));
+
+    REQUIRE_EQ(trie.num_delta_keys(), inserted.size());
+    for (std::uint64_t i = 0; i < inserted.size(); i++) {
+        REQUIRE_EQ(trie.lookup(inserted[i]), keys.size() + i);
+        REQUIRE_EQ(trie.decode(keys.size() + i), inserted[i]);
+    }
+}
@@ -0,0 +1,132 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "doctest/doctest.h"
+#include "test_common.hpp"
+#include "xcdat.hpp"
+
+using trie_type = xcdat::trie_8_type;
+using handle_type = xcdat::dictionary_handle<trie_type>;
+
+void test_lookup(const trie_type& trie, const std::vector<std::string>& keys) {
+    REQUIRE_EQ(trie.num_keys(), keys.size());
+    for (auto& key : keys) {
+        REQUIRE_EQ(trie.decode(trie.lookup(key).value()), key);
+    }
+}
+
+TEST_CASE("Test xcdat::dictionary_handle (reload)") {
+    const char* tmp_filepath = "tmp.handle";
+    const char* next_filepath = "tmp.handle.next";
+
+    auto keys1 = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, 'A', 'Z'));
+    auto keys2 = xcdat::test::extract_keys(keys1);
+    xcdat::save(trie_type(keys1), tmp_filepath);
+
+    handle_type handle(tmp_filepath);
+    REQUIRE_EQ(handle.version(), 1);
+    const auto old_trie = handle.get();
+    test_lookup(*old_trie, keys1);
+
+    // Replace the file with a rename and reload it, where the old dictionary is still mapped.
+    xcdat::save(trie_type(keys2), next_filepath);
+    REQUIRE_EQ(std::rename(next_filepath, tmp_filepath), 0);
+    handle.reload(tmp_filepath);
+    REQUIRE_EQ(handle.version(), 2);
+    test_lookup(*handle.get(), keys2);
+    test_lookup(*old_trie, keys1);
+
+    // The dictionary of a different type is rejected, and the current one is kept.
+    xcdat::save(xcdat::trie_16_type(keys1), next_filepath);
+    REQUIRE_THROWS_AS(handle.reload(next_filepath), xcdat::exception);
+    REQUIRE_THROWS_AS(handle.reload("not_found.handle"), xcdat::exception);
+    REQUIRE_EQ(handle.version(), 2);
+    test_lookup(*handle.get(), keys2);
+
+    std::remove(tmp_filepath);
+    std::remove(next_filepath);
+}
+
+// Count the mappings of the file in this process.
+std::uint64_t count_mappings(const std::string& filename) {
+    std::ifstream ifs("/proc/self/maps");
+    std::uint64_t count = 0;
+    for (std::string line; std::getline(ifs, line);) {
+        if (line.size() >= filename.size() &&
+            line.compare(line.size() - filename.size(), filename.size(), filename) == 0) {
+            count += 1;
+        }
+    }
+    return count;
+}
+
+TEST_CASE("Test xcdat::dictionary_handle (broken file)") {
+    const char* tmp_filepath = "tmp.handle.valid";
+    const char* broken_filepath = "tmp.handle.broken";
+
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, 'A', 'Z'));
+    xcdat::save(trie_type(keys), tmp_filepath);
+    xcdat::save(trie_type(keys), broken_filepath);
+    {
+        // Break the format magic following the type identifier, which fails after the file is mapped.
+        std::fstream fs(broken_filepath, std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekp(sizeof(std::uint32_t));
+        fs.put('\0');
+    }
+
+    handle_type handle(tmp_filepath);
+    REQUIRE_THROWS_AS(handle.reload(broken_filepath), xcdat::exception);
+    REQUIRE_EQ(count_mappings(broken_filepath), 0);  // unmapped on the error
+    REQUIRE_EQ(handle.version(), 1);
+    test_lookup(*handle.get(), keys);
+
+    std::remove(tmp_filepath);
+    std::remove(broken_filepath);
+}
+
+TEST_CASE("Test xcdat::dictionary_handle (concurrent readers)") {
+    const char* filepaths[] = {"tmp.handle.0", "tmp.handle.1"};
+
+    auto keys1 = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, INT8_MIN, INT8_MAX));
+    auto keys2 = xcdat::test::extract_keys(keys1);
+    xcdat::save(trie_type(keys1), filepaths[0]);
+    xcdat::save(trie_type(keys2), filepaths[1]);
+
+    handle_type handle(filepaths[0]);
+    std::atomic<bool> is_done = false;
+
+    // Each reader checks that a dictionary taken once is consistent, whichever version it is.
+    std::vector<std::thread> readers;
+    std::vector<std::uint64_t> num_errors(2);
+    for (std::uint64_t r = 0; r < num_errors.size(); r++) {
+        readers.emplace_back([&, r]() {
+            for (std::uint64_t i = r; !is_done.load(); i++) {
+                const auto trie = handle.get();
+                const auto& keys = trie->num_keys() == keys1.size() ? keys1 : keys2;
+                const auto& key = keys[i % keys.size()];
+                if (trie->decode(trie->lookup(key).value()) != key) {
+                    num_errors[r] += 1;
+                }
+            }
+        });
+    }
+
+    for (std::uint64_t i = 1; i <= 20; i++) {
+        handle.reload(filepaths[i % 2]);
+    }
+    is_done.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    REQUIRE_EQ(num_errors, std::vector<std::uint64_t>(num_errors.size(), 0));
+    REQUIRE_EQ(handle.version(), 21);
+    test_lookup(*handle.get(), keys1);
+
+    std::remove(filepaths[0]);
+    std::remove(filepaths[1]);
+}
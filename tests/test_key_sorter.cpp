@@ -0,0 +1,59 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <algorithm>
+#include <random>
+
+#include "doctest/doctest.h"
+#include "test_common.hpp"
+#include "xcdat/key_file.hpp"
+#include "xcdat/key_sorter.hpp"
+
+void test_key_sorter(const std::vector<std::string>& keys, std::uint64_t memory_budget, std::uint32_t num_threads) {
+    const auto expected = xcdat::test::to_unique_vec(std::vector<std::string>(keys));
+
+    {
+        xcdat::key_sorter sorter(memory_budget, num_threads);
+        for (const auto& key : keys) {
+            sorter.add(key);
+        }
+        REQUIRE_EQ(sorter.num_runs() != 0, memory_budget != xcdat::key_sorter::unlimited);
+
+        std::vector<std::string> merged;
+        const std::uint64_t num_keys = sorter.merge([&](std::string_view key) { merged.emplace_back(key); });
+        REQUIRE_EQ(num_keys, expected.size());
+        REQUIRE(merged == expected);
+    }
+
+    {
+        const char* tmp_filepath = "tmp.key_sorter.keys";
+
+        xcdat::key_sorter sorter(memory_budget, num_threads);
+        for (const auto& key : keys) {
+            sorter.add(key);
+        }
+        REQUIRE_EQ(sorter.write(tmp_filepath), expected.size());
+
+        const xcdat::key_file key_file(tmp_filepath, xcdat::key_file::format::length_prefixed);
+        REQUIRE_EQ(key_file.size(), expected.size());
+        for (std::uint64_t i = 0; i < expected.size(); i++) {
+            REQUIRE_EQ(key_file[i], expected[i]);
+        }
+
+        std::remove(tmp_filepath);
+    }
+}
+
+TEST_CASE("Test xcdat::key_sorter (in memory)") {
+    const auto keys = xcdat::test::make_random_keys(10000, 1, 10, 'A', 'C');
+    test_key_sorter(keys, xcdat::key_sorter::unlimited, 1);
+}
+
+TEST_CASE("Test xcdat::key_sorter (spilled, A--C)") {
+    const auto keys = xcdat::test::make_random_keys(10000, 1, 10, 'A', 'C');
+    test_key_sorter(keys, 4096, 1);
+}
+
+TEST_CASE("Test xcdat::key_sorter (spilled, 0x00--0xFF, 4 threads)") {
+    const auto keys = xcdat::test::make_random_keys(10000, 0, 30, INT8_MIN, INT8_MAX);
+    test_key_sorter(keys, 4096, 4);
+}
@@ -0,0 +1,137 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <string>
+
+#include "doctest/doctest.h"
+#include "mm_file/mm_file.hpp"
+#include "test_common.hpp"
+#include "xcdat.hpp"
+
+using sharded_trie_type = xcdat::sharded_trie<xcdat::bc_vector_8>;
+
+void test_basic_operations(const sharded_trie_type& trie, const std::vector<std::string>& keys,
+                           const std::vector<std::string>& others) {
+    REQUIRE_EQ(trie.num_keys(), keys.size());
+
+    std::vector<bool> used(keys.size());
+    for (std::uint64_t i = 0; i < keys.size(); i++) {
+        const auto id = trie.lookup(keys[i]);
+        REQUIRE(id.has_value());
+        REQUIRE_LT(id.value(), keys.size());
+        REQUIRE_FALSE(used[id.value()]);
+        used[id.value()] = true;
+        REQUIRE_EQ(trie.decode(id.value()), keys[i]);
+    }
+    for (auto& other : others) {
+        REQUIRE_FALSE(trie.lookup(other).has_value());
+    }
+}
+
+void test_searches(const sharded_trie_type& trie, const std::vector<std::string>& keys,
+                   const std::vector<std::string>& queries) {
+    for (auto& query : queries) {
+        std::vector<std::string> results;
+        trie.prefix_search(query, [&](std::uint64_t id, std::string_view decoded) {
+            REQUIRE_EQ(trie.decode(id), decoded);
+            results.emplace_back(decoded);
+        });
+        REQUIRE_EQ(results, xcdat::test::prefix_search_naive(keys, query));
+
+        const std::string_view prefix(query.data(), query.size() / 3);
+        results.clear();
+        trie.predictive_search(prefix, [&](std::uint64_t id, std::string_view decoded) {
+            REQUIRE_EQ(trie.decode(id), decoded);
+            results.emplace_back(decoded);
+        });
+        REQUIRE_EQ(results, xcdat::test::predictive_search_naive(keys, prefix));
+    }
+
+    std::uint64_t i = 0;
+    trie.enumerate([&](std::uint64_t id, std::string_view decoded) {
+        REQUIRE_EQ(decoded, keys[i++]);
+        REQUIRE_EQ(trie.lookup(decoded), id);
+    });
+    REQUIRE_EQ(i, keys.size());
+}
+
+void test_io(const sharded_trie_type& trie, const std::vector<std::string>& keys,
+             const std::vector<std::string>& others) {
+    const char* tmp_filepath = "tmp.sharded";
+
+    const std::uint64_t memory = xcdat::memory_in_bytes(trie);
+    REQUIRE_EQ(memory, xcdat::save(trie, tmp_filepath));
+
+    {
+        const auto loaded = xcdat::load<sharded_trie_type>(tmp_filepath);
+        REQUIRE_EQ(trie.num_shards(), loaded.num_shards());
+        REQUIRE_EQ(memory, xcdat::memory_in_bytes(loaded));
+        test_basic_operations(loaded, keys, others);
+    }
+    {
+        mm::file_source<char> fin(tmp_filepath, mm::advice::sequential);
+        const auto mapped = xcdat::mmap<sharded_trie_type>(fin.data());
+        REQUIRE_EQ(trie.num_shards(), mapped.num_shards());
+        REQUIRE_EQ(memory, xcdat::memory_in_bytes(mapped));
+        test_basic_operations(mapped, keys, others);
+    }
+    REQUIRE_THROWS_AS(xcdat::load<xcdat::trie_8_type>(tmp_filepath), xcdat::exception);
+
+    std::remove(tmp_filepath);
+}
+
+TEST_CASE("Test xcdat::sharded_trie (tiny)") {
+    std::vector<std::string> keys = {
+        "AirPods",  "AirTag",  "Mac",  "MacBook", "MacBook_Air", "MacBook_Pro",
+        "Mac_Mini", "Mac_Pro", "iMac", "iPad",    "iPhone",      "iPhone_SE",
+    };
+    std::vector<std::string> others = {
+        "Google_Pixel", "iPad_mini", "iPadOS", "iPod", "ThinkPad",
+    };
+
+    // The shards start with "AirPods", "Mac", "MacBook_Air", "Mac_Mini", "iMac", and "iPhone",
+    // so the prefixes of "MacBook_Pro_13inch" span the 2nd and 3rd shards.
+    sharded_trie_type trie(keys, 6);
+    REQUIRE_EQ(trie.num_shards(), 6);
+    REQUIRE_EQ(trie.shard_bound(2), "MacBook_Air");
+    REQUIRE_EQ(trie.shard_offset(2), 4);
+
+    test_basic_operations(trie, keys, others);
+    test_searches(trie, keys, {"MacBook_Pro_13inch", "MacBook", "Mac_Pro", "iPhone_SE", "i", ""});
+    test_io(trie, keys, others);
+}
+
+TEST_CASE("Test xcdat::sharded_trie (random 10K, A--B, 16 shards)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, 'A', 'B'));
+    auto others = xcdat::test::extract_keys(keys);
+    auto queries = xcdat::test::sample_keys(keys, 100);
+
+    sharded_trie_type trie(keys, 16);
+    trie.build_label_links(4);
+
+    test_basic_operations(trie, keys, others);
+    test_searches(trie, keys, queries);
+    test_io(trie, keys, others);
+}
+
+TEST_CASE("Test xcdat::sharded_trie (random 10K, 0x00--0xFF, 7 shards)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, INT8_MIN, INT8_MAX));
+    auto others = xcdat::test::extract_keys(keys);
+    auto queries = xcdat::test::sample_keys(keys, 100);
+
+    sharded_trie_type trie(keys, 7);
+
+    test_basic_operations(trie, keys, others);
+    test_searches(trie, keys, queries);
+    test_io(trie, keys, others);
+}
+
+TEST_CASE("Test xcdat::sharded_trie (more shards than keys)") {
+    std::vector<std::string> keys = {"", "A", "AB", "ABC", "B"};
+
+    sharded_trie_type trie(keys, 8);
+    REQUIRE_EQ(trie.num_shards(), keys.size());
+
+    test_basic_operations(trie, keys, {"AA", "C"});
+    test_searches(trie, keys, {"ABCD", "AB", "B", ""});
+    test_io(trie, keys, {"AA", "C"});
+}
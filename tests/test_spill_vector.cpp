@@ -0,0 +1,62 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <algorithm>
+#include <random>
+
+#include "doctest/doctest.h"
+#include "test_common.hpp"
+#include "xcdat/spill_vector.hpp"
+
+void test_spill_vector(const std::vector<std::uint64_t>& ints, std::uint64_t budget) {
+    xcdat::spill_vector<std::uint64_t> vec(budget);
+    for (std::uint64_t i = 0; i < ints.size(); i++) {
+        vec.push_back(ints[i]);
+    }
+
+    REQUIRE_EQ(vec.size(), ints.size());
+    REQUIRE_EQ(vec.is_spilled(), ints.size() * sizeof(std::uint64_t) > budget);
+
+    for (std::uint64_t i = 0; i < ints.size(); i++) {
+        REQUIRE_EQ(vec[i], ints[i]);
+    }
+
+    // Modify and sort in place
+    for (std::uint64_t i = 0; i < ints.size(); i++) {
+        vec[i] += 1;
+    }
+    std::sort(vec.begin(), vec.end());
+
+    auto expected = ints;
+    for (auto& x : expected) {
+        x += 1;
+    }
+    std::sort(expected.begin(), expected.end());
+    REQUIRE(std::equal(vec.begin(), vec.end(), expected.begin(), expected.end()));
+
+    // Move
+    xcdat::spill_vector<std::uint64_t> moved = std::move(vec);
+    REQUIRE_EQ(vec.size(), 0);
+    REQUIRE(std::equal(moved.begin(), moved.end(), expected.begin(), expected.end()));
+}
+
+TEST_CASE("Test xcdat::spill_vector (in memory)") {
+    const auto ints = xcdat::test::make_random_ints(10000, 0, UINT64_MAX);
+    test_spill_vector(ints, xcdat::spill_vector<std::uint64_t>::unlimited);
+}
+
+TEST_CASE("Test xcdat::spill_vector (spilled)") {
+    const auto ints = xcdat::test::make_random_ints(10000, 0, UINT64_MAX);
+    test_spill_vector(ints, 1024);
+}
+
+TEST_CASE("Test xcdat::spill_vector (resize)") {
+    xcdat::spill_vector<std::uint64_t> vec(1024);
+    vec.resize(100, 7);
+    REQUIRE_FALSE(vec.is_spilled());
+    vec.resize(10000, 9);
+    REQUIRE(vec.is_spilled());
+    REQUIRE_EQ(vec.size(), 10000);
+    for (std::uint64_t i = 0; i < vec.size(); i++) {
+        REQUIRE_EQ(vec[i], i < 100 ? 7 : 9);
+    }
+}
@@ -7,27 +7,57 @@
 #include "test_common.hpp"
 #include "xcdat/tail_vector.hpp"
 
-void test_tail_vector(const std::vector<std::string>& sufs, bool bin_mode = false) {
-    xcdat::tail_vector tvec;
-    std::vector<std::uint64_t> idxs(sufs.size());
-
-    {
-        xcdat::tail_vector::builder tvb;
-        for (std::uint64_t i = 0; i < sufs.size(); i++) {
-            tvb.set_suffix(sufs[i], i);
-        }
-        tvb.complete(bin_mode, [&](std::uint64_t npos, std::uint64_t tpos) { idxs[npos] = tpos; });
-        tvec = xcdat::tail_vector(std::move(tvb));
+xcdat::tail_vector build_tail_vector(const std::vector<std::string>& sufs, bool bin_mode, std::uint32_t num_threads,
+                                     std::vector<std::uint64_t>& idxs) {
+    idxs.resize(sufs.size());
+    xcdat::tail_vector::builder tvb;
+    for (std::uint64_t i = 0; i < sufs.size(); i++) {
+        tvb.set_suffix(sufs[i], i);
+    }
+    tvb.complete(
+        bin_mode, [&](std::uint64_t npos, std::uint64_t tpos) { idxs[npos] = tpos; }, num_threads);
+    return xcdat::tail_vector(std::move(tvb));
+}
+
+void test_tail_vector(const std::vector<std::string>& sufs, bool bin_mode = false, std::uint32_t num_threads = 1) {
+    std::vector<std::uint64_t> idxs;
+    const xcdat::tail_vector tvec = build_tail_vector(sufs, bin_mode, num_threads, idxs);
+
+    if (num_threads > 1) {
+        // The result must be identical to that of the serial construction.
+        std::vector<std::uint64_t> serial_idxs;
+        const xcdat::tail_vector serial_tvec = build_tail_vector(sufs, bin_mode, 1, serial_idxs);
+        REQUIRE_EQ(tvec.size(), serial_tvec.size());
+        REQUIRE(idxs == serial_idxs);
     }
 
     for (std::uint64_t i = 0; i < sufs.size(); i++) {
         REQUIRE(tvec.match(sufs[i], idxs[i]));
+        REQUIRE_EQ(tvec.prefix_match(sufs[i], idxs[i]), sufs[i].size());
+    }
+    for (std::uint64_t i = 0; i < sufs.size(); i++) {
+        const std::string longer = sufs[i] + '\0' + sufs[i];
+        REQUIRE_FALSE(tvec.match(longer, idxs[i]));
+        REQUIRE_EQ(tvec.prefix_match(longer, idxs[i]), sufs[i].size());
+
+        const std::string shorter = sufs[i].substr(0, sufs[i].size() - 1);
+        REQUIRE_FALSE(tvec.match(shorter, idxs[i]));
+
+        std::string other = sufs[i];
+        other.back() = static_cast<char>(other.back() + 1);
+        REQUIRE_FALSE(tvec.match(other, idxs[i]));
+        REQUIRE_FALSE(tvec.prefix_match(other, idxs[i]).has_value());
     }
     for (std::uint64_t i = 0; i < sufs.size(); i++) {
         std::string decoded;
         tvec.decode(idxs[i], [&](char c) { decoded.push_back(c); });
         REQUIRE_EQ(sufs[i], decoded);
     }
+    for (std::uint64_t i = 0; i < sufs.size(); i++) {
+        std::string decoded = "prefix";
+        tvec.decode(idxs[i], decoded);
+        REQUIRE_EQ("prefix" + sufs[i], decoded);
+    }
 }
 
 TEST_CASE("Test xcdat::tail_vector (tiny)") {
@@ -49,3 +79,28 @@ TEST_CASE("Test xcdat::tail_vector (random, 0x00--0xFF)") {
     std::vector<std::string> sufs = xcdat::test::make_random_keys(10000, 1, 30, INT8_MIN, INT8_MAX);
     test_tail_vector(sufs, true);
 }
+
+TEST_CASE("Test xcdat::tail_vector (random long, A--Z)") {
+    std::vector<std::string> sufs = xcdat::test::make_random_keys(10000, 1, 200, 'A', 'Z');
+    test_tail_vector(sufs);
+}
+
+TEST_CASE("Test xcdat::tail_vector (random long, 0x00--0xFF)") {
+    std::vector<std::string> sufs = xcdat::test::make_random_keys(10000, 1, 200, INT8_MIN, INT8_MAX);
+    test_tail_vector(sufs, true);
+}
+
+TEST_CASE("Test xcdat::tail_vector (random, A--B, 4 threads)") {
+    std::vector<std::string> sufs = xcdat::test::make_random_keys(10000, 1, 30, 'A', 'B');
+    test_tail_vector(sufs, false, 4);
+}
+
+TEST_CASE("Test xcdat::tail_vector (random, 0x00--0xFF, 4 threads)") {
+    std::vector<std::string> sufs = xcdat::test::make_random_keys(10000, 1, 30, INT8_MIN, INT8_MAX);
+    test_tail_vector(sufs, true, 4);
+}
+
+TEST_CASE("Test xcdat::tail_vector (tiny, 16 threads)") {
+    std::vector<std::string> sufs = {"ML", "STATS", "A", "M", "L", "AKDD", "M", "R", "DD", "OD"};
+    test_tail_vector(sufs, false, 16);
+}
@@ -1,7 +1,9 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 
 #include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <numeric>
 #include <random>
 #include <string>
 
@@ -13,17 +15,43 @@
 #ifdef TRIE_7
 using trie_type = xcdat::trie_7_type;
 #define TRIE_NAME "xcdat::trie_7_type"
+#define TRIE_TAG "trie_7"
 #elif TRIE_8
 using trie_type = xcdat::trie_8_type;
 #define TRIE_NAME "xcdat::trie_8_type"
+#define TRIE_TAG "trie_8"
 #elif TRIE_15
 using trie_type = xcdat::trie_15_type;
 #define TRIE_NAME "xcdat::trie_15_type"
+#define TRIE_TAG "trie_15"
 #elif TRIE_16
 using trie_type = xcdat::trie_16_type;
 #define TRIE_NAME "xcdat::trie_16_type"
+#define TRIE_TAG "trie_16"
+#elif TRIE_7i
+using trie_type = xcdat::trie_7i_type;
+#define TRIE_NAME "xcdat::trie_7i_type"
+#define TRIE_TAG "trie_7i"
+#elif TRIE_32
+using trie_type = xcdat::trie_32_type;
+#define TRIE_NAME "xcdat::trie_32_type"
+#define TRIE_TAG "trie_32"
+#elif TRIE_64
+using trie_type = xcdat::trie_64_type;
+#define TRIE_NAME "xcdat::trie_64_type"
+#define TRIE_TAG "trie_64"
 #endif
 
+// The temporary files are named after the trie type and the SIMD variant, since the test binaries can run in parallel.
+#if defined(__AVX2__)
+#define SIMD_TAG ".avx2"
+#elif defined(__SSE4_2__)
+#define SIMD_TAG ".sse42"
+#else
+#define SIMD_TAG ""
+#endif
+#define TMP_FILEPATH(ext) "tmp." TRIE_TAG SIMD_TAG "." ext
+
 std::vector<std::string> load_strings(const std::string& filepath, char delim = '\n') {
     std::ifstream ifs(filepath);
     XCDAT_THROW_IF(!ifs.good(), "Cannot open the input file");
@@ -52,6 +80,31 @@ void test_basic_operations(const trie_type& trie, const std::vector<std::string>
         auto id = trie.lookup(others[i]);
         REQUIRE_FALSE(id.has_value());
     }
+
+    {
+        std::vector<std::string_view> queries(keys.begin(), keys.end());
+        queries.insert(queries.end(), others.begin(), others.end());
+
+        std::vector<std::optional<std::uint64_t>> ids(queries.size());
+        trie.lookup_batch(queries.data(), queries.size(), ids.data());
+
+        for (std::uint64_t i = 0; i < queries.size(); i++) {
+            REQUIRE_EQ(ids[i], trie.lookup(queries[i]));
+        }
+    }
+
+    {
+        std::vector<std::uint64_t> ids(trie.num_keys() + 1);
+        std::iota(ids.rbegin(), ids.rend(), 0);  // including an invalid ID
+
+        std::string decoded;
+        std::vector<std::uint64_t> offsets(ids.size() + 1);
+        trie.decode_batch(ids.data(), ids.size(), decoded, offsets.data());
+
+        for (std::uint64_t i = 0; i < ids.size(); i++) {
+            REQUIRE_EQ(decoded.substr(offsets[i], offsets[i + 1] - offsets[i]), trie.decode(ids[i]));
+        }
+    }
 }
 
 void test_prefix_search(const trie_type& trie, const std::vector<std::string>& keys,
@@ -80,6 +133,7 @@ void test_prefix_search(const trie_type& trie, const std::vector<std::string>& k
 
 void test_predictive_search(const trie_type& trie, const std::vector<std::string>& keys,
                             const std::vector<std::string>& queries) {
+    typename trie_type::predictive_iterator reused_itr;
     for (auto& query : queries) {
         std::string_view query_view{query.c_str(), query.size() / 3 + 1};
 
@@ -101,6 +155,131 @@ void test_predictive_search(const trie_type& trie, const std::vector<std::string
         for (std::size_t i = 0; i < results.size(); i++) {
             REQUIRE_EQ(results[i], naive_results[i]);
         }
+
+        // The reused iterator must give the same results.
+        trie.reset_predictive_iterator(reused_itr, query_view);
+        for (std::size_t i = 0; i < results.size(); i++) {
+            REQUIRE(reused_itr.next());
+            REQUIRE_EQ(reused_itr.decoded_view(), results[i]);
+        }
+        REQUIRE_FALSE(reused_itr.next());
+    }
+}
+
+void test_bounds(const trie_type& trie, const std::vector<std::string>& keys, const std::vector<std::string>& others) {
+    // Both stored and missing keywords, and their neighbors
+    std::vector<std::string> queries = {""};
+    for (std::uint64_t i = 0; i < keys.size(); i += keys.size() / 50 + 1) {
+        queries.push_back(keys[i]);
+    }
+    for (std::uint64_t i = 0; i < others.size(); i += others.size() / 50 + 1) {
+        queries.push_back(others[i]);
+    }
+    for (std::uint64_t i = 1, size = queries.size(); i < size; i++) {
+        queries.push_back(queries[i].substr(0, queries[i].size() / 2));
+        queries.push_back(queries[i] + '\0');
+        if (!queries[i].empty()) {
+            queries.push_back(queries[i].substr(0, queries[i].size() - 1) + char(queries[i].back() + 1));
+        }
+    }
+
+    for (const auto& query : queries) {
+        const std::uint64_t lb = std::lower_bound(keys.begin(), keys.end(), query) - keys.begin();
+        const std::uint64_t ub = std::upper_bound(keys.begin(), keys.end(), query) - keys.begin();
+
+        REQUIRE_EQ(trie.lower_bound(query), lb != keys.size() ? trie.lookup(keys[lb]) : std::nullopt);
+        REQUIRE_EQ(trie.upper_bound(query), ub != keys.size() ? trie.lookup(keys[ub]) : std::nullopt);
+
+        auto lb_itr = trie.make_lower_bound_iterator(query);
+        for (std::uint64_t i = lb; i < std::min<std::uint64_t>(lb + 10, keys.size()); i++) {
+            REQUIRE(lb_itr.next());
+            REQUIRE_EQ(lb_itr.decoded_view(), keys[i]);
+            REQUIRE_EQ(lb_itr.id(), trie.lookup(keys[i]));
+        }
+        auto ub_itr = trie.make_upper_bound_iterator(query);
+        for (std::uint64_t i = ub; i < std::min<std::uint64_t>(ub + 10, keys.size()); i++) {
+            REQUIRE(ub_itr.next());
+            REQUIRE_EQ(ub_itr.decoded_view(), keys[i]);
+        }
+    }
+
+    for (std::uint64_t i = 0; i + 1 < queries.size(); i++) {
+        const auto& lo = std::min(queries[i], queries[i + 1]);
+        const auto& hi = std::max(queries[i], queries[i + 1]);
+        std::uint64_t pos = std::lower_bound(keys.begin(), keys.end(), lo) - keys.begin();
+        trie.range_search(lo, hi, [&](std::uint64_t id, std::string_view decoded) {
+            REQUIRE_EQ(decoded, keys[pos]);
+            REQUIRE_EQ(id, trie.lookup(keys[pos]));
+            pos += 1;
+        });
+        REQUIRE_EQ(pos, static_cast<std::uint64_t>(std::lower_bound(keys.begin(), keys.end(), hi) - keys.begin()));
+    }
+}
+
+void test_sorted_ids(const trie_type& trie, const std::vector<std::string>& keys) {
+    REQUIRE(trie.has_sorted_ids());
+
+    for (std::uint64_t i = 0; i < keys.size(); i++) {
+        REQUIRE_EQ(trie.lookup(keys[i]), i);
+        REQUIRE_EQ(trie.decode(i), keys[i]);
+    }
+
+    std::uint64_t expected_id = 0;
+    trie.enumerate([&](std::uint64_t id, std::string_view) { REQUIRE_EQ(id, expected_id++); });
+    REQUIRE_EQ(expected_id, keys.size());
+
+    for (std::uint64_t i = 0; i < keys.size(); i += keys.size() / 100 + 1) {
+        const std::string query = keys[i] + '\0';
+        REQUIRE_EQ(trie.lower_bound(keys[i]), i);
+        REQUIRE_EQ(trie.upper_bound(keys[i]), i + 1 < keys.size() ? std::optional<std::uint64_t>(i + 1) : std::nullopt);
+        REQUIRE_EQ(trie.lower_bound(query), i + 1 < keys.size() ? std::optional<std::uint64_t>(i + 1) : std::nullopt);
+    }
+}
+
+// Distinct scores, so that the top-k results are unique.
+std::vector<std::uint64_t> make_random_scores(std::uint64_t n, std::uint64_t seed = 13) {
+    std::vector<std::uint64_t> scores(n);
+    std::iota(scores.begin(), scores.end(), 0);
+    std::shuffle(scores.begin(), scores.end(), std::mt19937_64(seed));
+    return scores;
+}
+
+void test_predictive_topk(const trie_type& trie, const std::vector<std::string>& keys,
+                          const std::vector<std::uint64_t>& scores, const std::vector<std::string>& queries) {
+    REQUIRE(trie.has_scores());
+
+    for (std::uint64_t i = 0; i < keys.size(); i++) {
+        REQUIRE_EQ(trie.score(trie.lookup(keys[i]).value()), scores[i]);
+    }
+
+    std::vector<std::string_view> query_views;
+    for (auto& query : queries) {
+        query_views.emplace_back(query.c_str(), query.size() / 3);
+        query_views.emplace_back(query);  // possibly running past a leaf
+    }
+
+    for (std::string_view query_view : query_views) {
+        std::vector<std::pair<std::uint64_t, std::string>> naive_results;
+        for (std::uint64_t i = 0; i < keys.size(); i++) {
+            if (std::string_view(keys[i]).substr(0, query_view.size()) == query_view) {
+                naive_results.emplace_back(scores[i], keys[i]);
+            }
+        }
+        std::sort(naive_results.begin(), naive_results.end(), std::greater<>());
+
+        for (std::uint64_t k : {0, 1, 3, 10, 100}) {
+            const auto ids = trie.predictive_topk(query_view, k);
+            REQUIRE_EQ(ids.size(), std::min<std::uint64_t>(k, naive_results.size()));
+
+            std::uint64_t i = 0;
+            trie.predictive_topk(query_view, k, [&](std::uint64_t id, std::string_view decoded) {
+                REQUIRE_EQ(id, ids[i]);
+                REQUIRE_EQ(trie.score(id), naive_results[i].first);
+                REQUIRE_EQ(decoded, naive_results[i].second);
+                i += 1;
+            });
+            REQUIRE_EQ(i, ids.size());
+        }
     }
 }
 
@@ -112,10 +291,17 @@ void test_enumerate(const trie_type& trie, const std::vector<std::string>& keys)
         REQUIRE_EQ(itr.id(), trie.lookup(key));
     }
     REQUIRE_FALSE(itr.next());
+
+    trie.reset_enumerative_iterator(itr);
+    for (auto& key : keys) {
+        REQUIRE(itr.next());
+        REQUIRE_EQ(itr.decoded_view(), key);
+    }
+    REQUIRE_FALSE(itr.next());
 }
 
 void test_io(const trie_type& trie, const std::vector<std::string>& keys, const std::vector<std::string>& others) {
-    const char* tmp_filepath = "tmp.idx";
+    const char* tmp_filepath = TMP_FILEPATH("idx");
 
     const std::uint64_t memory = xcdat::memory_in_bytes(trie);
     REQUIRE_EQ(memory, xcdat::save(trie, tmp_filepath));
@@ -130,6 +316,7 @@ void test_io(const trie_type& trie, const std::vector<std::string>& keys, const
         REQUIRE_EQ(trie.num_units(), loaded.num_units());
         REQUIRE_EQ(trie.num_free_units(), loaded.num_free_units());
         REQUIRE_EQ(trie.tail_length(), loaded.tail_length());
+        REQUIRE_EQ(trie.has_scores(), loaded.has_scores());
         REQUIRE_EQ(memory, xcdat::memory_in_bytes(loaded));
         test_basic_operations(loaded, keys, others);
     }
@@ -145,10 +332,29 @@ void test_io(const trie_type& trie, const std::vector<std::string>& keys, const
         REQUIRE_EQ(trie.num_units(), mapped.num_units());
         REQUIRE_EQ(trie.num_free_units(), mapped.num_free_units());
         REQUIRE_EQ(trie.tail_length(), mapped.tail_length());
+        REQUIRE_EQ(trie.has_scores(), mapped.has_scores());
         REQUIRE_EQ(memory, xcdat::memory_in_bytes(mapped));
         test_basic_operations(mapped, keys, others);
     }
 
+    {
+        // The file of an older version, which has no magic word after the type identifier, is rejected.
+        std::string bytes;
+        {
+            std::ifstream ifs(tmp_filepath, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        }
+        bytes.erase(sizeof(std::uint32_t), sizeof(trie_type::format_magic));
+        {
+            std::ofstream ofs(tmp_filepath, std::ios::binary);
+            ofs.write(bytes.data(), bytes.size());
+        }
+        REQUIRE_THROWS_AS(xcdat::load<trie_type>(tmp_filepath), xcdat::exception);
+
+        mm::file_source<char> fin(tmp_filepath, mm::advice::sequential);
+        REQUIRE_THROWS_AS(xcdat::mmap<trie_type>(fin.data()), xcdat::exception);
+    }
+
     std::remove(tmp_filepath);
 }
 
@@ -165,6 +371,7 @@ TEST_CASE("Test " TRIE_NAME " (tiny)") {
     REQUIRE_FALSE(trie.bin_mode());
 
     test_basic_operations(trie, keys, others);
+    test_bounds(trie, keys, others);
 
     {
         auto itr = trie.make_prefix_iterator("MacBook_Pro_13inch");
@@ -199,6 +406,35 @@ TEST_CASE("Test " TRIE_NAME " (tiny)") {
     test_io(trie, keys, others);
 }
 
+TEST_CASE("Test " TRIE_NAME " (scores, queries past leaves)") {
+    std::vector<std::string> keys = {"ab", "b", "ba"};
+    std::vector<std::uint64_t> scores = {3, 1, 2};
+
+    trie_type trie(keys);
+    trie.build_scores(keys, scores);
+
+    // "ba" is a leaf with an empty TAIL and "ab" is a leaf with the TAIL "b", which must not match "bax" and "abx".
+    REQUIRE(trie.predictive_topk("bax", 10).empty());
+    REQUIRE(trie.predictive_topk("abx", 10).empty());
+    REQUIRE_EQ(trie.predictive_topk("ba", 10), std::vector<std::uint64_t>{trie.lookup("ba").value()});
+    test_predictive_topk(trie, keys, scores, {"ab", "abx", "b", "ba", "bax", "bb", ""});
+    test_predictive_search(trie, keys, {"ab", "abx", "b", "ba", "bax", "bb", ""});
+}
+
+TEST_CASE("Test " TRIE_NAME " (single key)") {
+    for (const std::string key : {"", "A", "MacBook"}) {
+        std::vector<std::string> keys = {key};
+        std::vector<std::string> others = {key + "A", "B"};
+
+        trie_type trie(keys);
+        test_basic_operations(trie, keys, others);
+        test_prefix_search(trie, keys, {key + "_Pro", key});
+        test_predictive_search(trie, keys, {key, key + "A"});
+        test_enumerate(trie, keys);
+        test_bounds(trie, keys, others);
+    }
+}
+
 TEST_CASE("Test " TRIE_NAME " (unsort)") {
     std::vector<std::string> keys = {
         "AirPods",  "AirTag",  "Mac",  "MacBook", "MacBook_Pro", "MacBook_Air",
@@ -231,6 +467,7 @@ TEST_CASE("Test " TRIE_NAME " (real)") {
     test_prefix_search(trie, keys, queries);
     test_predictive_search(trie, keys, queries);
     test_enumerate(trie, keys);
+    test_bounds(trie, keys, others);
     test_io(trie, keys, others);
 }
 
@@ -246,6 +483,7 @@ TEST_CASE("Test " TRIE_NAME " (random 10K, A--B)") {
     test_prefix_search(trie, keys, queries);
     test_predictive_search(trie, keys, queries);
     test_enumerate(trie, keys);
+    test_bounds(trie, keys, others);
     test_io(trie, keys, others);
 }
 
@@ -276,7 +514,248 @@ TEST_CASE("Test " TRIE_NAME " (random 10K, 0x00--0xFF)") {
     test_prefix_search(trie, keys, queries);
     test_predictive_search(trie, keys, queries);
     test_enumerate(trie, keys);
+    test_bounds(trie, keys, others);
+    test_io(trie, keys, others);
+}
+
+TEST_CASE("Test " TRIE_NAME " (real, 4 threads)") {
+    auto keys = xcdat::test::to_unique_vec(load_strings("keys.txt"));
+    auto others = xcdat::test::extract_keys(keys);
+    auto queries = xcdat::test::sample_keys(keys, 100);
+
+    trie_type trie(keys, false, 4);
+    REQUIRE_FALSE(trie.bin_mode());
+
+    test_basic_operations(trie, keys, others);
+    test_prefix_search(trie, keys, queries);
+    test_predictive_search(trie, keys, queries);
+    test_enumerate(trie, keys);
+    test_io(trie, keys, others);
+}
+
+TEST_CASE("Test " TRIE_NAME " (random 10K, A--B, 4 threads)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, 'A', 'B'));
+    auto others = xcdat::test::extract_keys(keys);
+    auto queries = xcdat::test::sample_keys(keys, 100);
+
+    trie_type trie(keys, false, 4);
+    REQUIRE_FALSE(trie.bin_mode());
+
+    test_basic_operations(trie, keys, others);
+    test_prefix_search(trie, keys, queries);
+    test_predictive_search(trie, keys, queries);
+    test_enumerate(trie, keys);
+    test_io(trie, keys, others);
+}
+
+TEST_CASE("Test " TRIE_NAME " (random 10K, 0x00--0xFF, 4 threads)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, INT8_MIN, INT8_MAX));
+    auto others = xcdat::test::extract_keys(keys);
+    auto queries = xcdat::test::sample_keys(keys, 100);
+
+    trie_type trie(keys, false, 4);
+    REQUIRE(trie.bin_mode());
+
+    test_basic_operations(trie, keys, others);
+    test_prefix_search(trie, keys, queries);
+    test_predictive_search(trie, keys, queries);
+    test_enumerate(trie, keys);
+    test_io(trie, keys, others);
+}
+
+TEST_CASE("Test " TRIE_NAME " (unsort, 4 threads)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, 'A', 'Z'));
+    std::swap(keys[1000], keys[9000]);
+
+    auto func = [&]() { auto trie = trie_type(keys, false, 4); };
+    REQUIRE_THROWS_AS(func(), const xcdat::exception&);
+}
+
+TEST_CASE("Test " TRIE_NAME " (real, label links)") {
+    auto keys = xcdat::test::to_unique_vec(load_strings("keys.txt"));
+    auto others = xcdat::test::extract_keys(keys);
+    auto queries = xcdat::test::sample_keys(keys, 100);
+
+    trie_type trie(keys);
+    trie.build_label_links();
+    REQUIRE(trie.has_label_links());
+    REQUIRE_EQ(trie.label_links_memory_in_bytes(), sizeof(std::uint64_t) + trie.num_units() * 2);
+
+    test_basic_operations(trie, keys, others);
+    test_predictive_search(trie, keys, queries);
+    test_enumerate(trie, keys);
+    test_bounds(trie, keys, others);
+    test_io(trie, keys, others);
+}
+
+TEST_CASE("Test " TRIE_NAME " (random 10K, 0x00--0xFF, label links, 4 threads)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, INT8_MIN, INT8_MAX));
+    auto others = xcdat::test::extract_keys(keys);
+    auto queries = xcdat::test::sample_keys(keys, 100);
+
+    trie_type trie(keys, false, 4);
+    trie.build_label_links(4);
+    REQUIRE(trie.bin_mode());
+    REQUIRE(trie.has_label_links());
+
+    test_basic_operations(trie, keys, others);
+    test_predictive_search(trie, keys, queries);
+    test_enumerate(trie, keys);
+    test_bounds(trie, keys, others);
+    test_io(trie, keys, others);
+}
+
+TEST_CASE("Test " TRIE_NAME " (real, scores)") {
+    auto keys = xcdat::test::to_unique_vec(load_strings("keys.txt"));
+    auto others = xcdat::test::extract_keys(keys);
+    auto queries = xcdat::test::sample_keys(keys, 100);
+    auto scores = make_random_scores(keys.size());
+
+    trie_type trie(keys);
+    REQUIRE_THROWS_AS(trie.predictive_topk("", 1), xcdat::exception);
+    trie.build_scores(keys, scores);
+
+    test_basic_operations(trie, keys, others);
+    test_predictive_topk(trie, keys, scores, queries);
+    test_io(trie, keys, others);
+
+    // The label links give the same results.
+    trie.build_label_links();
+    test_predictive_topk(trie, keys, scores, queries);
+}
+
+TEST_CASE("Test " TRIE_NAME " (random 10K, 0x00--0xFF, scores, 4 threads)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, INT8_MIN, INT8_MAX));
+    auto queries = xcdat::test::sample_keys(keys, 100);
+    auto scores = make_random_scores(keys.size());
+
+    trie_type trie(keys, false, 4);
+    trie.build_scores(keys, scores, 4);
+    REQUIRE(trie.bin_mode());
+
+    test_predictive_topk(trie, keys, scores, queries);
+}
+
+TEST_CASE("Test " TRIE_NAME " (real, sorted IDs)") {
+    auto keys = xcdat::test::to_unique_vec(load_strings("keys.txt"));
+    auto others = xcdat::test::extract_keys(keys);
+    auto queries = xcdat::test::sample_keys(keys, 100);
+    auto scores = make_random_scores(keys.size());
+
+    trie_type trie(keys);
+    trie.build_scores(keys, scores);
+    trie.build_sorted_ids();
+
+    test_sorted_ids(trie, keys);
+    test_basic_operations(trie, keys, others);
+    test_prefix_search(trie, keys, queries);
+    test_predictive_search(trie, keys, queries);
+    test_predictive_topk(trie, keys, scores, queries);
+    test_enumerate(trie, keys);
+    test_bounds(trie, keys, others);
     test_io(trie, keys, others);
+
+    {
+        const char* tmp_filepath = TMP_FILEPATH("idx");
+        xcdat::save(trie, tmp_filepath);
+        const auto loaded = xcdat::load<trie_type>(tmp_filepath);
+        test_sorted_ids(loaded, keys);
+        std::remove(tmp_filepath);
+    }
+}
+
+TEST_CASE("Test " TRIE_NAME " (random 10K, 0x00--0xFF, sorted IDs, label links, 4 threads)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, INT8_MIN, INT8_MAX));
+    auto others = xcdat::test::extract_keys(keys);
+    auto queries = xcdat::test::sample_keys(keys, 100);
+
+    trie_type trie(keys, false, 4);
+    trie.build_label_links(4);
+    trie.build_sorted_ids();
+    REQUIRE(trie.bin_mode());
+
+    test_sorted_ids(trie, keys);
+    test_basic_operations(trie, keys, others);
+    test_prefix_search(trie, keys, queries);
+    test_predictive_search(trie, keys, queries);
+    test_bounds(trie, keys, others);
+}
+
+TEST_CASE("Test " TRIE_NAME " (real, key_file, spilled)") {
+    auto keys = xcdat::test::to_unique_vec(load_strings("keys.txt"));
+    auto others = xcdat::test::extract_keys(keys);
+    auto queries = xcdat::test::sample_keys(keys, 100);
+
+    const char* tmp_filepath = TMP_FILEPATH("keys");
+    {
+        std::ofstream ofs(tmp_filepath);
+        for (const auto& key : keys) {
+            ofs << key << '\n';
+        }
+    }
+
+    // Spill all the buffers
+    const std::uint64_t memory_budget = 1024;
+    const xcdat::key_file key_file(tmp_filepath, xcdat::key_file::format::newline, memory_budget);
+    REQUIRE(key_file.is_spilled());
+    REQUIRE_EQ(key_file.size(), keys.size());
+
+    trie_type trie(key_file, false, 1, memory_budget);
+    REQUIRE_FALSE(trie.bin_mode());
+
+    // Identical to the trie built in memory
+    trie_type expected(keys);
+    REQUIRE_EQ(xcdat::memory_in_bytes(trie), xcdat::memory_in_bytes(expected));
+    for (std::uint64_t i = 0; i < keys.size(); i++) {
+        REQUIRE_EQ(trie.lookup(keys[i]), expected.lookup(keys[i]));
+    }
+
+    test_basic_operations(trie, keys, others);
+    test_prefix_search(trie, keys, queries);
+    test_predictive_search(trie, keys, queries);
+    test_enumerate(trie, keys);
+
+    std::remove(tmp_filepath);
+}
+
+TEST_CASE("Test " TRIE_NAME " (random 10K, 0x00--0xFF, length-prefixed key_file)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, INT8_MIN, INT8_MAX));
+    auto others = xcdat::test::extract_keys(keys);
+
+    const char* tmp_filepath = TMP_FILEPATH("keys");
+    {
+        std::ofstream ofs(tmp_filepath, std::ios::binary);
+        for (const auto& key : keys) {
+            const std::uint32_t length = key.size();
+            for (std::uint32_t j = 0; j < 4; j++) {
+                ofs.put(static_cast<char>((length >> (j * 8)) & 0xFF));
+            }
+            ofs << key;
+        }
+    }
+
+    const xcdat::key_file key_file(tmp_filepath, xcdat::key_file::format::length_prefixed);
+    REQUIRE_EQ(key_file.size(), keys.size());
+
+    trie_type trie(key_file, false, 4, 1024);
+    REQUIRE(trie.bin_mode());
+
+    test_basic_operations(trie, keys, others);
+    test_enumerate(trie, keys);
+
+    // A broken file is rejected without leaking the descriptor, which would take the lowest free number.
+    {
+        std::ofstream ofs(tmp_filepath, std::ios::binary | std::ios::app);
+        ofs.put('\x01');
+    }
+    const int free_fd = ::open("/dev/null", O_RDONLY);
+    ::close(free_fd);
+    REQUIRE_THROWS_AS(xcdat::key_file(tmp_filepath, xcdat::key_file::format::length_prefixed), xcdat::exception);
+    const int next_fd = ::open("/dev/null", O_RDONLY);
+    ::close(next_fd);
+    REQUIRE_EQ(free_fd, next_fd);
+
+    std::remove(tmp_filepath);
 }
 
 #ifdef NDEBUG
@@ -0,0 +1,88 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <string>
+
+#include "doctest/doctest.h"
+#include "mm_file/mm_file.hpp"
+#include "test_common.hpp"
+#include "xcdat.hpp"
+
+using int_map_type = xcdat::trie_map<xcdat::bc_vector_8, xcdat::int_value_codec>;
+using blob_map_type = xcdat::trie_map<xcdat::bc_vector_7, xcdat::blob_value_codec>;
+
+template <class Map, class Values>
+void test_trie_map(const Map& map, const std::vector<std::string>& keys, const Values& values,
+                   const std::vector<std::string>& others) {
+    REQUIRE_EQ(map.num_keys(), keys.size());
+
+    for (std::uint64_t i = 0; i < keys.size(); i++) {
+        const auto id = map.lookup(keys[i]);
+        REQUIRE(id.has_value());
+        REQUIRE_EQ(map.decode(id.value()), keys[i]);
+        REQUIRE_EQ(map.value(id.value()), values[i]);
+        REQUIRE_EQ(map.get(keys[i]), values[i]);
+    }
+    for (auto& other : others) {
+        REQUIRE_FALSE(map.get(other).has_value());
+    }
+}
+
+template <class Map, class Values>
+void test_io(const Map& map, const std::vector<std::string>& keys, const Values& values,
+             const std::vector<std::string>& others) {
+    const char* tmp_filepath = "tmp.map";
+
+    const std::uint64_t memory = xcdat::memory_in_bytes(map);
+    REQUIRE_EQ(memory, xcdat::save(map, tmp_filepath));
+    REQUIRE_EQ(xcdat::get_type_id(tmp_filepath), Map::type_id);
+
+    {
+        const auto loaded = xcdat::load<Map>(tmp_filepath);
+        REQUIRE_EQ(memory, xcdat::memory_in_bytes(loaded));
+        test_trie_map(loaded, keys, values, others);
+    }
+    {
+        mm::file_source<char> fin(tmp_filepath, mm::advice::sequential);
+        const auto mapped = xcdat::mmap<Map>(fin.data());
+        REQUIRE_EQ(memory, xcdat::memory_in_bytes(mapped));
+        test_trie_map(mapped, keys, values, others);
+    }
+    REQUIRE_THROWS_AS(xcdat::load<xcdat::trie_8_type>(tmp_filepath), xcdat::exception);
+
+    std::remove(tmp_filepath);
+}
+
+TEST_CASE("Test xcdat::trie_map with int_value_codec (random 10K, A--Z)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, 'A', 'Z'));
+    auto others = xcdat::test::extract_keys(keys);
+    auto values = xcdat::test::make_random_ints(keys.size(), 0, 1000000);
+
+    int_map_type map(keys, values);
+    test_trie_map(map, keys, values, others);
+    test_io(map, keys, values, others);
+}
+
+TEST_CASE("Test xcdat::trie_map with blob_value_codec (random 10K, 0x00--0xFF, 4 threads)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, INT8_MIN, INT8_MAX));
+    auto others = xcdat::test::extract_keys(keys);
+
+    // Values of various lengths including empty ones
+    std::vector<std::string> values(keys.size());
+    for (std::uint64_t i = 0; i < keys.size(); i++) {
+        values[i] = std::string(i % 7, static_cast<char>(i)) + keys[i];
+        if (i % 5 == 0) {
+            values[i].clear();
+        }
+    }
+
+    blob_map_type map(keys, values, false, 4);
+    REQUIRE(map.get_trie().bin_mode());
+    test_trie_map(map, keys, values, others);
+    test_io(map, keys, values, others);
+}
+
+TEST_CASE("Test xcdat::trie_map (different sizes)") {
+    std::vector<std::string> keys = {"Mac", "MacBook", "iMac"};
+    std::vector<std::uint64_t> values = {1, 2};
+    REQUIRE_THROWS_AS(int_map_type(keys, values), xcdat::exception);
+}
@@ -0,0 +1,65 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <algorithm>
+#include <string>
+
+#include "doctest/doctest.h"
+#include "test_common.hpp"
+#include "xcdat.hpp"
+
+using trie_type = xcdat::trie_8_type;
+
+void test_merge(const std::vector<std::string>& a_keys, const std::vector<std::string>& b_keys,
+                std::uint32_t num_threads = 1) {
+    const trie_type a(a_keys);
+    trie_type b(b_keys);
+    b.build_sorted_ids();  // The old IDs can be order-preserving ones.
+
+    std::vector<std::string> keys;
+    std::set_union(a_keys.begin(), a_keys.end(), b_keys.begin(), b_keys.end(), std::back_inserter(keys));
+
+    const auto result = xcdat::merge(a, b, false, num_threads);
+    REQUIRE_EQ(result.trie.num_keys(), keys.size());
+    REQUIRE_EQ(result.a_ids.size(), a.num_keys());
+    REQUIRE_EQ(result.b_ids.size(), b.num_keys());
+
+    for (auto& key : keys) {
+        REQUIRE(result.trie.lookup(key).has_value());
+    }
+    for (auto& key : a_keys) {
+        REQUIRE_EQ(result.a_ids[a.lookup(key).value()], result.trie.lookup(key));
+    }
+    for (auto& key : b_keys) {
+        REQUIRE_EQ(result.b_ids[b.lookup(key).value()], result.trie.lookup(key));
+    }
+}
+
+TEST_CASE("Test xcdat::merge (tiny)") {
+    std::vector<std::string> a_keys = {"AirPods", "Mac", "MacBook", "MacBook_Air", "iMac", "iPhone"};
+    std::vector<std::string> b_keys = {"", "AirTag", "Mac", "Mac_Mini", "iMac", "iPad", "iPhone_SE"};
+    test_merge(a_keys, b_keys);
+    test_merge(b_keys, a_keys);
+    test_merge(a_keys, a_keys);
+}
+
+TEST_CASE("Test xcdat::merge (random 10K, 0x00--0xFF, 4 threads)") {
+    auto keys = xcdat::test::to_unique_vec(xcdat::test::make_random_keys(10000, 1, 30, INT8_MIN, INT8_MAX));
+    auto a_keys = xcdat::test::extract_keys(keys, 0.3);
+    auto b_keys = keys;
+    b_keys.insert(b_keys.end(), a_keys.begin(), a_keys.begin() + a_keys.size() / 2);  // overlapped
+    std::sort(b_keys.begin(), b_keys.end());
+    test_merge(a_keys, b_keys, 4);
+}
+
+TEST_CASE("Test xcdat::merge (with an empty trie)") {
+    std::vector<std::string> keys = {"A", "AB", "B"};
+    const trie_type a(keys);
+    const trie_type b{};
+
+    const auto result = xcdat::merge(a, b);
+    REQUIRE_EQ(result.trie.num_keys(), keys.size());
+    REQUIRE(result.b_ids.empty());
+    for (std::uint64_t i = 0; i < keys.size(); i++) {
+        REQUIRE_EQ(result.a_ids[a.lookup(keys[i]).value()], result.trie.lookup(keys[i]));
+    }
+}
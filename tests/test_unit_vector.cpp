@@ -0,0 +1,52 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <random>
+
+#include "doctest/doctest.h"
+#include "test_common.hpp"
+#include "xcdat/unit_vector.hpp"
+
+void test_unit_vector(const std::vector<std::uint64_t>& ints) {
+    const std::uint64_t size = ints.size() / 2;
+
+    xcdat::unit_vector units;
+    for (std::uint64_t i = 0; i < size; i++) {
+        units.push_back(0, 0);
+    }
+    REQUIRE_FALSE(units.is_wide());
+
+    bool wide = false;
+    for (std::uint64_t i = 0; i < size; i++) {
+        units.set_base(i, ints[i * 2]);
+        units.set_check(i, ints[i * 2 + 1]);
+        wide = wide || ints[i * 2] > UINT32_MAX || ints[i * 2 + 1] > UINT32_MAX;
+        REQUIRE_EQ(units.is_wide(), wide);
+    }
+
+    REQUIRE_EQ(units.size(), size);
+    for (std::uint64_t i = 0; i < size; i++) {
+        REQUIRE_EQ(units[i].base, ints[i * 2]);
+        REQUIRE_EQ(units[i].check, ints[i * 2 + 1]);
+    }
+}
+
+TEST_CASE("Test xcdat::unit_vector (compact)") {
+    test_unit_vector(xcdat::test::make_random_ints(20000, 0, UINT32_MAX));
+}
+
+TEST_CASE("Test xcdat::unit_vector (widened)") {
+    auto ints = xcdat::test::make_random_ints(20000, 0, UINT32_MAX);
+    ints[10000] = UINT64_MAX;
+    test_unit_vector(ints);
+}
+
+TEST_CASE("Test xcdat::unit_vector (prepare)") {
+    xcdat::unit_vector units;
+    units.push_back(1, 2);
+    units.prepare(UINT32_MAX);
+    REQUIRE_FALSE(units.is_wide());
+    units.prepare(1ULL << 32);
+    REQUIRE(units.is_wide());
+    REQUIRE_EQ(units[0].base, 1);
+    REQUIRE_EQ(units[0].check, 2);
+}
@@ -1,9 +1,12 @@
 #include <chrono>
+#include <cstring>
+#include <functional>
 #include <random>
 
 #include <xcdat.hpp>
 
 #include "cmd_line_parser/parser.hpp"
+#include "mm_file/mm_file.hpp"
 #include "tinyformat/tinyformat.h"
 
 static constexpr int num_trials = 10;
@@ -14,6 +17,7 @@ cmd_line_parser::parser make_parser(int argc, char** argv) {
     p.add("num_samples", "Number of sample keys for searches (default=1000)", "-n", false);
     p.add("random_seed", "Random seed for sampling (default=13)", "-s", false);
     p.add("binary_mode", "Is binary mode? (default=0)", "-b", false);
+    p.add("zero_copy", "Map the input file and use the keys without copying? (default=0)", "-z", false);
     return p;
 }
 
@@ -28,8 +32,24 @@ std::vector<std::string> load_strings(const std::string& filepath, char delim =
     return strs;
 }
 
-std::vector<std::string_view> sample_keys(const std::vector<std::string>& keys, std::uint64_t num_samples,
-                                          std::uint64_t random_seed) {
+// Split the memory-mapped file into views of the lines without copying them.
+std::vector<std::string_view> load_string_views(const mm::file_source<char>& fin, char delim = '\n') {
+    std::vector<std::string_view> strs;
+    const char* beg = fin.data();
+    const char* end = beg + fin.size();
+    while (beg < end) {
+        const char* pos = static_cast<const char*>(std::memchr(beg, delim, end - beg));
+        if (pos == nullptr) {
+            pos = end;
+        }
+        strs.emplace_back(beg, pos - beg);
+        beg = pos + 1;
+    }
+    return strs;
+}
+
+template <class Strings>
+std::vector<std::string_view> sample_keys(const Strings& keys, std::uint64_t num_samples, std::uint64_t random_seed) {
     std::mt19937_64 engine(random_seed);
     std::uniform_int_distribution<std::uint64_t> dist(0, keys.size() - 1);
 
@@ -49,8 +69,8 @@ std::vector<std::uint64_t> extract_ids(const Trie& trie, const std::vector<std::
     return sampled_ids;
 }
 
-template <class Trie>
-Trie benchmark_build(const std::vector<std::string>& keys, bool binary_mode) {
+template <class Trie, class Strings>
+Trie benchmark_build(const Strings& keys, bool binary_mode) {
     const auto start_tp = std::chrono::high_resolution_clock::now();
     Trie trie(keys, binary_mode);
     const auto stop_tp = std::chrono::high_resolution_clock::now();
@@ -63,12 +83,13 @@ Trie benchmark_build(const std::vector<std::string>& keys, bool binary_mode) {
     tfm::printfln("Memory usage in bytes: %d", memory_in_bytes);
     tfm::printfln("Memory usage in MiB: %g", memory_in_bytes / (1024.0 * 1024.0));
     tfm::printfln("Construction time in seconds: %g", time_in_sec);
+    tfm::printfln("Construction time in nanosec/key: %g", dur_ms.count() * 1000000.0 / trie.num_keys());
 
     return trie;
 }
 
 template <class Trie>
-void benchmark_lookup(const Trie& trie, const std::vector<std::string_view>& queries) {
+void benchmark_lookup(const Trie& trie, const std::vector<std::string_view>& queries, const char* note = "") {
     // Warmup
     volatile std::uint64_t tmp = 0;
     for (const auto& query : queries) {
@@ -87,11 +108,38 @@ void benchmark_lookup(const Trie& trie, const std::vector<std::string_view>& que
     const auto dur_us = std::chrono::duration_cast<std::chrono::microseconds>(stop_tp - start_tp);
     const auto elapsed_us = static_cast<double>(dur_us.count());
 
-    tfm::printfln("Lookup time in microsec/query: %g", elapsed_us / (num_trials * queries.size()));
+    tfm::printfln("Lookup time in microsec/query%s: %g", note, elapsed_us / (num_trials * queries.size()));
+}
+
+template <class Trie>
+void benchmark_lookup_batch(const Trie& trie, const std::vector<std::string_view>& queries, const char* note = "") {
+    std::vector<std::optional<std::uint64_t>> ids(queries.size());
+
+    // Warmup
+    volatile std::uint64_t tmp = 0;
+    trie.lookup_batch(queries.data(), queries.size(), ids.data());
+    for (const auto& id : ids) {
+        tmp += id.value();
+    }
+
+    // Measure
+    const auto start_tp = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < num_trials; r++) {
+        trie.lookup_batch(queries.data(), queries.size(), ids.data());
+        for (const auto& id : ids) {
+            tmp += id.value();
+        }
+    }
+    const auto stop_tp = std::chrono::high_resolution_clock::now();
+
+    const auto dur_us = std::chrono::duration_cast<std::chrono::microseconds>(stop_tp - start_tp);
+    const auto elapsed_us = static_cast<double>(dur_us.count());
+
+    tfm::printfln("Batch lookup time in microsec/query%s: %g", note, elapsed_us / (num_trials * queries.size()));
 }
 
 template <class Trie>
-void benchmark_decode(const Trie& trie, const std::vector<std::uint64_t>& queries) {
+void benchmark_decode(const Trie& trie, const std::vector<std::uint64_t>& queries, const char* note = "") {
     // Warmup
     volatile std::uint64_t tmp = 0;
     for (const std::uint64_t query : queries) {
@@ -110,35 +158,179 @@ void benchmark_decode(const Trie& trie, const std::vector<std::uint64_t>& querie
     const auto dur_us = std::chrono::duration_cast<std::chrono::microseconds>(stop_tp - start_tp);
     const auto elapsed_us = static_cast<double>(dur_us.count());
 
-    tfm::printfln("Decode time in microsec/query: %g", elapsed_us / (num_trials * queries.size()));
+    tfm::printfln("Decode time in microsec/query%s: %g", note, elapsed_us / (num_trials * queries.size()));
 }
 
 template <class Trie>
-void benchmark(std::vector<std::string> keys, const std::vector<std::string_view>& query_keys, bool binary_mode) {
-    const auto trie = benchmark_build<Trie>(keys, binary_mode);
-    const auto query_ids = extract_ids(trie, query_keys);
+void benchmark_decode_batch(const Trie& trie, const std::vector<std::uint64_t>& queries, const char* note = "") {
+    std::string decoded;
+    std::vector<std::uint64_t> offsets(queries.size() + 1);
 
-    benchmark_lookup(trie, query_keys);
-    benchmark_decode(trie, query_ids);
+    // Warmup
+    volatile std::uint64_t tmp = 0;
+    trie.decode_batch(queries.data(), queries.size(), decoded, offsets.data());
+    tmp += decoded.size();
+
+    // Measure
+    const auto start_tp = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < num_trials; r++) {
+        trie.decode_batch(queries.data(), queries.size(), decoded, offsets.data());
+        tmp += decoded.size();
+    }
+    const auto stop_tp = std::chrono::high_resolution_clock::now();
+
+    const auto dur_us = std::chrono::duration_cast<std::chrono::microseconds>(stop_tp - start_tp);
+    const auto elapsed_us = static_cast<double>(dur_us.count());
+
+    tfm::printfln("Batch decode time in microsec/query%s: %g", note, elapsed_us / (num_trials * queries.size()));
 }
 
-int main(int argc, char** argv) {
-#ifndef NDEBUG
-    tfm::warnfln("The code is running in debug mode.");
-#endif
-    std::ios::sync_with_stdio(false);
+template <class Trie>
+void benchmark_enumerate(const Trie& trie, const char* note = "") {
+    // Measure the callback through std::function
+    std::uint64_t tmp = 0;
+    const std::function<void(std::uint64_t, std::string_view)> fn = [&](std::uint64_t id, std::string_view str) {
+        tmp += id + str.size();
+    };
+    auto start_tp = std::chrono::high_resolution_clock::now();
+    trie.enumerate(fn);
+    auto stop_tp = std::chrono::high_resolution_clock::now();
+    const auto dur_fn_us = std::chrono::duration_cast<std::chrono::microseconds>(stop_tp - start_tp);
+
+    // Measure the inlined callback
+    start_tp = std::chrono::high_resolution_clock::now();
+    trie.enumerate([&](std::uint64_t id, std::string_view str) { tmp += id + str.size(); });
+    stop_tp = std::chrono::high_resolution_clock::now();
+    const auto dur_us = std::chrono::duration_cast<std::chrono::microseconds>(stop_tp - start_tp);
 
-    auto p = make_parser(argc, argv);
-    if (!p.parse()) {
-        return 1;
+    volatile std::uint64_t sink = tmp;
+    (void)sink;
+
+    tfm::printfln("Enumerate time in nanosec/key (std::function%s): %g", note,
+                  dur_fn_us.count() * 1000.0 / trie.num_keys());
+    tfm::printfln("Enumerate time in nanosec/key (inlined%s): %g", note, dur_us.count() * 1000.0 / trie.num_keys());
+}
+
+template <class Trie>
+void benchmark_range_search(const Trie& trie, const std::vector<std::string_view>& queries, std::uint64_t length,
+                            const char* note = "") {
+    std::uint64_t tmp = 0;
+    auto start_tp = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < num_trials; r++) {
+        for (const auto query : queries) {
+            tmp += trie.lower_bound(query).value_or(0);
+        }
     }
+    auto stop_tp = std::chrono::high_resolution_clock::now();
+    const auto dur_lb_us = std::chrono::duration_cast<std::chrono::microseconds>(stop_tp - start_tp);
+
+    // Scan 'length' keywords from the lower bound of each query
+    std::uint64_t num_keys = 0;
+    start_tp = std::chrono::high_resolution_clock::now();
+    for (const auto query : queries) {
+        auto itr = trie.make_lower_bound_iterator(query);
+        for (std::uint64_t i = 0; i < length && itr.next(); i++) {
+            tmp += itr.id() + itr.decoded_view().size();
+            num_keys += 1;
+        }
+    }
+    stop_tp = std::chrono::high_resolution_clock::now();
+    const auto dur_scan_us = std::chrono::duration_cast<std::chrono::microseconds>(stop_tp - start_tp);
 
-    const auto input_keys = p.get<std::string>("input_keys");
+    volatile std::uint64_t sink = tmp;
+    (void)sink;
+
+    tfm::printfln("Lower bound time in microsec/query%s: %g", note,
+                  static_cast<double>(dur_lb_us.count()) / (num_trials * queries.size()));
+    tfm::printfln("Range search time in nanosec/key%s (%d keys from lower bound): %g", note, length,
+                  dur_scan_us.count() * 1000.0 / num_keys);
+}
+
+template <class Trie>
+void benchmark_predictive_topk(const Trie& trie, const std::vector<std::string_view>& queries, std::uint64_t k) {
+    // Short prefixes of the sample keys, as typed in query autocompletion
+    std::vector<std::string_view> prefixes(queries.size());
+    for (std::uint64_t i = 0; i < queries.size(); i++) {
+        prefixes[i] = queries[i].substr(0, 2);
+    }
+
+    // Measure the baseline that enumerates all the completions and selects the best ones
+    std::uint64_t tmp = 0;
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> completions;
+    auto start_tp = std::chrono::high_resolution_clock::now();
+    for (const auto prefix : prefixes) {
+        completions.clear();
+        trie.predictive_search(prefix, [&](std::uint64_t id, std::string_view) {
+            completions.emplace_back(trie.score(id), id);
+        });
+        const auto mid = completions.begin() + std::min<std::uint64_t>(k, completions.size());
+        std::partial_sort(completions.begin(), mid, completions.end(), std::greater<>());
+        for (auto it = completions.begin(); it != mid; ++it) {
+            tmp += trie.decode(it->second).size();
+        }
+    }
+    auto stop_tp = std::chrono::high_resolution_clock::now();
+    const auto dur_all_us = std::chrono::duration_cast<std::chrono::microseconds>(stop_tp - start_tp);
+
+    start_tp = std::chrono::high_resolution_clock::now();
+    for (const auto prefix : prefixes) {
+        trie.predictive_topk(prefix, k, [&](std::uint64_t id, std::string_view str) { tmp += id + str.size(); });
+    }
+    stop_tp = std::chrono::high_resolution_clock::now();
+    const auto dur_us = std::chrono::duration_cast<std::chrono::microseconds>(stop_tp - start_tp);
+
+    volatile std::uint64_t sink = tmp;
+    (void)sink;
+
+    tfm::printfln("Top-%d predictive search time in microsec/query (enumerate and sort): %g", k,
+                  static_cast<double>(dur_all_us.count()) / prefixes.size());
+    tfm::printfln("Top-%d predictive search time in microsec/query (predictive_topk): %g", k,
+                  static_cast<double>(dur_us.count()) / prefixes.size());
+}
+
+template <class Trie, class Strings>
+void benchmark(const Strings& keys, const std::vector<std::string_view>& query_keys, bool binary_mode) {
+    auto trie = benchmark_build<Trie>(keys, binary_mode);
+    const auto query_ids = extract_ids(trie, query_keys);
+
+    benchmark_lookup(trie, query_keys);
+    benchmark_lookup_batch(trie, query_keys);
+    benchmark_decode(trie, query_ids);
+    benchmark_decode_batch(trie, query_ids);
+    benchmark_enumerate(trie);
+    benchmark_range_search(trie, query_keys, 100);
+
+    trie.build_label_links();
+    tfm::printfln("Memory usage of label links in MiB: %g", trie.label_links_memory_in_bytes() / (1024.0 * 1024.0));
+    benchmark_enumerate(trie, ", label links");
+    benchmark_range_search(trie, query_keys, 100, " with label links");
+
+    // Random scores as the weights of the keys
+    std::vector<std::uint64_t> scores(keys.size());
+    std::mt19937_64 engine(13);
+    for (auto& score : scores) {
+        score = engine() % keys.size();
+    }
+    trie.build_scores(keys, scores);
+    tfm::printfln("Memory usage of scores in MiB: %g", trie.scores_memory_in_bytes() / (1024.0 * 1024.0));
+    benchmark_predictive_topk(trie, query_keys, 10);
+
+    // The IDs are changed into the ranks of the keys
+    trie.build_sorted_ids();
+    tfm::printfln("Memory usage of sorted IDs in MiB: %g", trie.sorted_ids_memory_in_bytes() / (1024.0 * 1024.0));
+    const auto sorted_query_ids = extract_ids(trie, query_keys);
+    benchmark_lookup(trie, query_keys, " with sorted IDs");
+    benchmark_lookup_batch(trie, query_keys, " with sorted IDs");
+    benchmark_decode(trie, sorted_query_ids, " with sorted IDs");
+    benchmark_decode_batch(trie, sorted_query_ids, " with sorted IDs");
+}
+
+template <class Strings>
+int run(const cmd_line_parser::parser& p, Strings& keys) {
     const auto num_samples = p.get<std::uint64_t>("num_samples", 1000);
     const auto random_seed = p.get<std::uint64_t>("random_seed", 13);
     const auto binary_mode = p.get<bool>("binary_mode", false);
 
-    auto keys = load_strings(input_keys);
     if (keys.empty()) {
         tfm::errorfln("Error: The input dataset is empty.");
         return 1;
@@ -161,5 +353,38 @@ int main(int argc, char** argv) {
     tfm::printfln("** xcdat::trie_16_type **");
     benchmark<xcdat::trie_16_type>(keys, query_keys, binary_mode);
 
+    tfm::printfln("** xcdat::trie_7i_type **");
+    benchmark<xcdat::trie_7i_type>(keys, query_keys, binary_mode);
+
+    tfm::printfln("** xcdat::trie_32_type **");
+    benchmark<xcdat::trie_32_type>(keys, query_keys, binary_mode);
+
+    tfm::printfln("** xcdat::trie_64_type **");
+    benchmark<xcdat::trie_64_type>(keys, query_keys, binary_mode);
+
     return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char** argv) {
+#ifndef NDEBUG
+    tfm::warnfln("The code is running in debug mode.");
+#endif
+    std::ios::sync_with_stdio(false);
+
+    auto p = make_parser(argc, argv);
+    if (!p.parse()) {
+        return 1;
+    }
+
+    const auto input_keys = p.get<std::string>("input_keys");
+    const auto zero_copy = p.get<bool>("zero_copy", false);
+
+    if (zero_copy) {
+        mm::file_source<char> fin(input_keys, mm::advice::sequential);
+        auto keys = load_string_views(fin);
+        return run(p, keys);
+    }
+
+    auto keys = load_strings(input_keys);
+    return run(p, keys);
+}
@@ -1,17 +1,49 @@
+#include <sys/resource.h>
+
+#include <cstring>
+
 #include <xcdat.hpp>
 
 #include "cmd_line_parser/parser.hpp"
+#include "mm_file/mm_file.hpp"
 #include "tinyformat/tinyformat.h"
 
 cmd_line_parser::parser make_parser(int argc, char** argv) {
     cmd_line_parser::parser p(argc, argv);
     p.add("input_keys", "Input filepath of keywords");
     p.add("output_dic", "Output filepath of trie dictionary");
-    p.add("trie_type", "Trie type: [7|8|15|16] (default=8)", "-t", false);
+    p.add("trie_type", "Trie type: [7|8|15|16|71|32|64] (default=8), where 71 is the interleaved variant of 7", "-t", false);
     p.add("binary_mode", "Is binary mode? (default=0)", "-b", false);
+    p.add("num_threads", "Number of threads for construction (default=1)", "-j", false);
+    p.add("sorted_input", "Stream the input keys from the file, which must be sorted and unique? (default=0)", "-s",
+          false);
+    p.add("length_prefixed", "Are the input keys length-prefixed (4-byte little endian)? Only with -s (default=0)",
+          "-p", false);
+    p.add("external_sort", "Sort the keys with runs spilled to temporary files beyond the memory budget? (default=0)",
+          "-e", false);
+    p.add("zero_copy", "Map the input file and build from the keys without copying them? (default=0)", "-z", false);
+    p.add("label_links", "Build the label links for faster predictive search and enumeration? (default=0)", "-l",
+          false);
+    p.add("sorted_ids", "Assign IDs in lexicographical order of the keys, i.e., order-preserving IDs? (default=0)", "-o",
+          false);
+    p.add("memory_budget", "Memory budget in MiB; larger construction buffers are spilled to temporary files",
+          "-m", false);
     return p;
 }
 
+// The peak resident set size of the process in bytes
+std::uint64_t get_peak_memory_in_bytes() {
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(ru.ru_maxrss);
+#else
+    return static_cast<std::uint64_t>(ru.ru_maxrss) * 1024;
+#endif
+}
+
 std::vector<std::string> load_strings(const std::string& filepath, char delim = '\n') {
     std::ifstream ifs(filepath);
     XCDAT_THROW_IF(!ifs.good(), "Cannot open the input file");
@@ -23,13 +55,24 @@ std::vector<std::string> load_strings(const std::string& filepath, char delim =
     return strs;
 }
 
-template <class Trie>
-int build(const cmd_line_parser::parser& p) {
-    const auto input_keys = p.get<std::string>("input_keys");
-    const auto output_dic = p.get<std::string>("output_dic");
-    const auto binary_mode = p.get<bool>("binary_mode", false);
+// Split the memory-mapped file into views of the lines without copying them.
+std::vector<std::string_view> load_string_views(const mm::file_source<char>& fin, char delim = '\n') {
+    std::vector<std::string_view> strs;
+    const char* beg = fin.data();
+    const char* end = beg + fin.size();
+    while (beg < end) {
+        const char* pos = static_cast<const char*>(std::memchr(beg, delim, end - beg));
+        if (pos == nullptr) {
+            pos = end;
+        }
+        strs.emplace_back(beg, pos - beg);
+        beg = pos + 1;
+    }
+    return strs;
+}
 
-    auto keys = load_strings(input_keys);
+template <class Trie, class Strings>
+Trie sort_and_build(Strings& keys, bool binary_mode, std::uint32_t num_threads, std::uint64_t memory_budget) {
     if (keys.empty()) {
         tfm::errorfln("Error: The input dataset is empty.");
     }
@@ -37,7 +80,86 @@ int build(const cmd_line_parser::parser& p) {
     std::sort(keys.begin(), keys.end());
     keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
 
-    const Trie trie(keys, binary_mode);
+    return Trie(keys, binary_mode, num_threads, memory_budget);
+}
+
+// Remove the temporary file on destruction.
+struct temp_file_remover {
+    std::string path;
+
+    explicit temp_file_remover(std::string p) : path(std::move(p)) {}
+    ~temp_file_remover() {
+        std::remove(path.c_str());
+    }
+    temp_file_remover(const temp_file_remover&) = delete;
+    temp_file_remover& operator=(const temp_file_remover&) = delete;
+};
+
+template <class Trie>
+Trie build_trie(const cmd_line_parser::parser& p) {
+    const auto input_keys = p.get<std::string>("input_keys");
+    const auto binary_mode = p.get<bool>("binary_mode", false);
+    const auto num_threads = p.get<std::uint32_t>("num_threads", 1);
+    const auto sorted_input = p.get<bool>("sorted_input", false);
+    const auto length_prefixed = p.get<bool>("length_prefixed", false);
+    const auto external_sort = p.get<bool>("external_sort", false);
+    const auto zero_copy = p.get<bool>("zero_copy", false);
+    const auto memory_budget = p.parsed("memory_budget") ? p.get<std::uint64_t>("memory_budget") * 1024 * 1024
+                                                      : xcdat::spill_vector<std::uint64_t>::unlimited;
+
+    if (sorted_input) {
+        const auto format = length_prefixed ? xcdat::key_file::format::length_prefixed  //
+                                            : xcdat::key_file::format::newline;
+        const xcdat::key_file keys(input_keys, format, memory_budget);
+        if (keys.size() == 0) {
+            tfm::errorfln("Error: The input dataset is empty.");
+        }
+        return Trie(keys, binary_mode, num_threads, memory_budget);
+    }
+
+    if (external_sort) {
+        // The sorted unique keys are merged into a temporary key file, from which the trie is built.
+        // The file is removed on leaving the scope even if an exception is thrown,
+        // while the mapping of key_file remains valid until closed.
+        const temp_file_remover sorted_keys(p.get<std::string>("output_dic") + ".sorted.tmp");
+        {
+            xcdat::key_sorter sorter(memory_budget, num_threads);
+            std::ifstream ifs(input_keys);
+            XCDAT_THROW_IF(!ifs.good(), "Cannot open the input file");
+            for (std::string str; std::getline(ifs, str);) {
+                sorter.add(str);
+            }
+            tfm::printfln("Number of spilled runs: %d", sorter.num_runs());
+            sorter.write(sorted_keys.path);
+        }
+        const xcdat::key_file keys(sorted_keys.path, xcdat::key_file::format::length_prefixed, memory_budget);
+        if (keys.size() == 0) {
+            tfm::errorfln("Error: The input dataset is empty.");
+        }
+        return Trie(keys, binary_mode, num_threads, memory_budget);
+    }
+
+    if (zero_copy) {
+        mm::file_source<char> fin(input_keys, mm::advice::sequential);
+        auto keys = load_string_views(fin);
+        return sort_and_build<Trie>(keys, binary_mode, num_threads, memory_budget);
+    }
+
+    auto keys = load_strings(input_keys);
+    return sort_and_build<Trie>(keys, binary_mode, num_threads, memory_budget);
+}
+
+template <class Trie>
+int build(const cmd_line_parser::parser& p) {
+    const auto output_dic = p.get<std::string>("output_dic");
+
+    Trie trie = build_trie<Trie>(p);
+    if (p.get<bool>("label_links", false)) {
+        trie.build_label_links(p.get<std::uint32_t>("num_threads", 1));
+    }
+    if (p.get<bool>("sorted_ids", false)) {
+        trie.build_sorted_ids();
+    }
     const double memory_in_bytes = xcdat::memory_in_bytes(trie);
 
     tfm::printfln("Number of keys: %d", trie.num_keys());
@@ -45,6 +167,13 @@ int build(const cmd_line_parser::parser& p) {
     tfm::printfln("Number of DA units: %d", trie.num_units());
     tfm::printfln("Memory usage in bytes: %d", memory_in_bytes);
     tfm::printfln("Memory usage in MiB: %g", memory_in_bytes / (1024.0 * 1024.0));
+    if (trie.has_label_links()) {
+        tfm::printfln("Memory usage of label links in MiB: %g", trie.label_links_memory_in_bytes() / (1024.0 * 1024.0));
+    }
+    if (trie.has_sorted_ids()) {
+        tfm::printfln("Memory usage of sorted IDs in MiB: %g", trie.sorted_ids_memory_in_bytes() / (1024.0 * 1024.0));
+    }
+    tfm::printfln("Peak memory usage in construction in MiB: %g", get_peak_memory_in_bytes() / (1024.0 * 1024.0));
 
     xcdat::save(trie, output_dic);
 
@@ -64,17 +193,29 @@ int main(int argc, char** argv) {
 
     const auto trie_type = p.get<int>("trie_type", 8);
 
-    switch (trie_type) {
-        case 7:
-            return build<xcdat::trie_7_type>(p);
-        case 8:
-            return build<xcdat::trie_8_type>(p);
-        case 15:
-            return build<xcdat::trie_15_type>(p);
-        case 16:
-            return build<xcdat::trie_16_type>(p);
-        default:
-            break;
+    // The exception is caught so that the stack is unwound and the temporary files are removed.
+    try {
+        switch (trie_type) {
+            case 7:
+                return build<xcdat::trie_7_type>(p);
+            case 8:
+                return build<xcdat::trie_8_type>(p);
+            case 15:
+                return build<xcdat::trie_15_type>(p);
+            case 16:
+                return build<xcdat::trie_16_type>(p);
+            case 71:
+                return build<xcdat::trie_7i_type>(p);
+            case 32:
+                return build<xcdat::trie_32_type>(p);
+            case 64:
+                return build<xcdat::trie_64_type>(p);
+            default:
+                break;
+        }
+    } catch (const xcdat::exception& ex) {
+        tfm::errorfln("%s", ex.what());
+        return 1;
     }
 
     p.help();
@@ -48,6 +48,12 @@ int main(int argc, char** argv) {
             return decode<xcdat::trie_15_type>(p);
         case 16:
             return decode<xcdat::trie_16_type>(p);
+        case 71:
+            return decode<xcdat::trie_7i_type>(p);
+        case 32:
+            return decode<xcdat::trie_32_type>(p);
+        case 64:
+            return decode<xcdat::trie_64_type>(p);
         default:
             break;
     }
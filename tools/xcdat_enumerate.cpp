@@ -45,6 +45,12 @@ int main(int argc, char** argv) {
             return enumerate<xcdat::trie_15_type>(p);
         case 16:
             return enumerate<xcdat::trie_16_type>(p);
+        case 71:
+            return enumerate<xcdat::trie_7i_type>(p);
+        case 32:
+            return enumerate<xcdat::trie_32_type>(p);
+        case 64:
+            return enumerate<xcdat::trie_64_type>(p);
         default:
             break;
     }
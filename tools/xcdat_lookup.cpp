@@ -1,3 +1,5 @@
+#include <csignal>
+
 #include <xcdat.hpp>
 
 #include "cmd_line_parser/parser.hpp"
@@ -7,23 +9,61 @@
 cmd_line_parser::parser make_parser(int argc, char** argv) {
     cmd_line_parser::parser p(argc, argv);
     p.add("input_dic", "Input filepath of trie dictionary");
+    p.add("reload", "Reload the dictionary from input_dic on SIGHUP without stopping the lookups? (default=0)", "-r",
+          false);
     return p;
 }
 
+volatile std::sig_atomic_t g_reload_requested = 0;
+
+void request_reload(int) {
+    g_reload_requested = 1;
+}
+
+void print_lookup(const std::optional<std::uint64_t>& id, const std::string& str) {
+    if (id.has_value()) {
+        tfm::printfln("%d\t%s", id.value(), str);
+    } else {
+        tfm::printfln("-1\t%s", str);
+    }
+}
+
+// Each query takes the current dictionary from the handle, which is replaced in a SIGHUP-driven reload.
+// The reload is done at the next query, and a broken or mistyped file is reported while keeping the old one.
+template <class Trie>
+int lookup_with_reload(const std::string& input_dic) {
+    xcdat::dictionary_handle<Trie> handle(input_dic);
+    std::signal(SIGHUP, request_reload);
+
+    for (std::string str; std::getline(std::cin, str);) {
+        if (g_reload_requested != 0) {
+            g_reload_requested = 0;
+            try {
+                handle.reload(input_dic);
+                tfm::warnfln("Reloaded %s (version %d)", input_dic, handle.version());
+            } catch (const xcdat::exception& ex) {
+                tfm::warnfln("Failed to reload %s: %s", input_dic, ex.what());
+            }
+        }
+        const auto trie = handle.get();
+        print_lookup(trie->lookup(str), str);
+    }
+
+    return 0;
+}
+
 template <class Trie>
 int lookup(const cmd_line_parser::parser& p) {
     const auto input_dic = p.get<std::string>("input_dic");
+    if (p.get<bool>("reload", false)) {
+        return lookup_with_reload<Trie>(input_dic);
+    }
 
     const mm::file_source<char> fin(input_dic.c_str(), mm::advice::sequential);
     const auto trie = xcdat::mmap<Trie>(fin.data());
 
     for (std::string str; std::getline(std::cin, str);) {
-        const auto id = trie.lookup(str);
-        if (id.has_value()) {
-            tfm::printfln("%d\t%s", id.value(), str);
-        } else {
-            tfm::printfln("-1\t%s", str);
-        }
+        print_lookup(trie.lookup(str), str);
     }
 
     return 0;
@@ -52,6 +92,12 @@ int main(int argc, char** argv) {
             return lookup<xcdat::trie_15_type>(p);
         case 16:
             return lookup<xcdat::trie_16_type>(p);
+        case 71:
+            return lookup<xcdat::trie_7i_type>(p);
+        case 32:
+            return lookup<xcdat::trie_32_type>(p);
+        case 64:
+            return lookup<xcdat::trie_64_type>(p);
         default:
             break;
     }
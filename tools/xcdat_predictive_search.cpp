@@ -65,6 +65,12 @@ int main(int argc, char** argv) {
             return predictive_search<xcdat::trie_15_type>(p);
         case 16:
             return predictive_search<xcdat::trie_16_type>(p);
+        case 71:
+            return predictive_search<xcdat::trie_7i_type>(p);
+        case 32:
+            return predictive_search<xcdat::trie_32_type>(p);
+        case 64:
+            return predictive_search<xcdat::trie_64_type>(p);
         default:
             break;
     }